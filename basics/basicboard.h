@@ -105,7 +105,7 @@ public:
 	 * Checks, if king side castling is allowed
 	 */
 	template <Piece COLOR>
-	inline bool isKingSideCastleAllowed() {
+	inline bool isKingSideCastleAllowed() const {
 		return boardState.isKingSideCastleAllowed<COLOR>();
 	}
 
@@ -113,7 +113,7 @@ public:
 	 * Checks, if queen side castling is allowed
 	 */
 	template <Piece COLOR>
-	inline bool isQueenSideCastleAllowed() {
+	inline bool isQueenSideCastleAllowed() const {
 		return boardState.isQueenSideCastleAllowed<COLOR>();
 	}
 
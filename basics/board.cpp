@@ -55,6 +55,28 @@ void Board::setToSymetricBoard(const Board& board) {
 	setWhiteToMove(!board.isWhiteToMove());
 }
 
+PositionSnapshot Board::getSnapshot() const {
+	PositionSnapshot snapshot;
+	for (Piece piece = MIN_PIECE; piece <= BLACK_KING; ++piece) {
+		snapshot.pieceBB[piece - MIN_PIECE] = bitBoardsPiece[piece];
+	}
+	snapshot.boardState = _basicBoard.boardState;
+	snapshot.whiteToMove = _basicBoard.whiteToMove;
+	return snapshot;
+}
+
+void Board::setFromSnapshot(const PositionSnapshot& snapshot) {
+	clear();
+	for (Piece piece = MIN_PIECE; piece <= BLACK_KING; ++piece) {
+		for (bitBoard_t pieceBB = snapshot.getPieceBB(piece); pieceBB; pieceBB &= pieceBB - 1) {
+			setPiece(lsb(pieceBB), piece);
+		}
+	}
+	// Restores castling rights, ep, halfmove counters and the (identical) hashes
+	_basicBoard.boardState = snapshot.boardState;
+	_basicBoard.whiteToMove = snapshot.whiteToMove;
+}
+
 void Board::removePiece(Square squareOfPiece) {
 	Piece pieceToRemove = _basicBoard[squareOfPiece];
 	removePieceBB(squareOfPiece, pieceToRemove);
@@ -254,7 +276,26 @@ string Board::getFen() const {
 		}
 	}
 
-	result += isWhiteToMove()? " w" : " b";
+	result += isWhiteToMove()? " w " : " b ";
+
+	const size_t castlingStart = result.size();
+	if (isKingSideCastleAllowed<WHITE>()) result.push_back('K');
+	if (isQueenSideCastleAllowed<WHITE>()) result.push_back('Q');
+	if (isKingSideCastleAllowed<BLACK>()) result.push_back('k');
+	if (isQueenSideCastleAllowed<BLACK>()) result.push_back('q');
+	if (result.size() == castlingStart) result.push_back('-');
+
+	// Only the file of the stored en passant square is reliable, the rank follows from the side to move
+	const Square ep = getEP();
+	if (ep != 0) {
+		result += " ";
+		result.push_back(char('a' + int(getFile(ep))));
+		result.push_back(isWhiteToMove() ? '6' : '3');
+	}
+	else {
+		result += " -";
+	}
+	result += " " + std::to_string(getTotalHalfmovesWithoutPawnMoveOrCapture()) + " 1";
 
 	return result;
 }
@@ -31,6 +31,7 @@
 #include "piecesignature.h"
 #include "materialbalance.h"
 #include "pst.h"
+#include "positionsnapshot.h"
 
 namespace QaplaBasics {
 
@@ -87,7 +88,7 @@ namespace QaplaBasics {
 		 * Checks, if king side castling is allowed
 		 */
 		template <Piece COLOR>
-		inline bool isKingSideCastleAllowed() {
+		inline bool isKingSideCastleAllowed() const {
 			return _basicBoard.isKingSideCastleAllowed<COLOR>();
 		}
 
@@ -95,7 +96,7 @@ namespace QaplaBasics {
 		 * Checks, if queen side castling is allowed
 		 */
 		template <Piece COLOR>
-		inline bool isQueenSideCastleAllowed() {
+		inline bool isQueenSideCastleAllowed() const {
 			return _basicBoard.isQueenSideCastleAllowed<COLOR>();
 		}
 
@@ -340,6 +341,16 @@ namespace QaplaBasics {
 
 		BoardState getBoardState() const { return _basicBoard.boardState; }
 
+		/**
+		 * Creates a compact snapshot of the current position
+		 */
+		PositionSnapshot getSnapshot() const;
+
+		/**
+		 * Sets the board to a position stored in a snapshot, the eval settings of the board are kept
+		 */
+		void setFromSnapshot(const PositionSnapshot& snapshot);
+
 		/**
 		 * Gets the board in Fen representation
 		 */
@@ -374,6 +385,17 @@ namespace QaplaBasics {
 			randomBonus = bonus;
 		}
 
+		/**
+		 * Seed of the random eval bonus. The bonus is a hash of seed and position, thus it is
+		 * reproducible and the same on every visit of a position.
+		 */
+		uint64_t getRandomSeed() const {
+			return randomSeed;
+		}
+		void setRandomSeed(uint64_t seed) {
+			randomSeed = seed;
+		}
+
 	protected:
 		array<Square, COLOR_COUNT> kingSquares;
 
@@ -448,6 +470,7 @@ namespace QaplaBasics {
 		void printPst(Piece piece) const;
 
 		value_t randomBonus = 0;
+		uint64_t randomSeed = 0;
 		uint32_t evalVersion = 0;
 		EvalValue _pstBonus;
 		PieceSignature _pieceSignature;
@@ -52,7 +52,7 @@ namespace QaplaBasics {
 		 * Checks, if castling king side is allowed
 		 */
 		template <Piece COLOR>
-		bool isKingSideCastleAllowed() {
+		bool isKingSideCastleAllowed() const {
 			return (_info & (COLOR == WHITE ? WHITE_KING_SIDE_CASTLE_BIT : BLACK_KING_SIDE_CASTLE_BIT)) != 0;
 		}
 
@@ -60,7 +60,7 @@ namespace QaplaBasics {
 		 * Checks, if castling queen side is allowed
 		 */
 		template <Piece COLOR>
-		bool isQueenSideCastleAllowed() {
+		bool isQueenSideCastleAllowed() const {
 			return (_info & (COLOR == WHITE ? WHITE_QUEEN_SIDE_CASTLE_BIT : BLACK_QUEEN_SIDE_CASTLE_BIT)) != 0;
 		}
 
@@ -28,8 +28,14 @@
 
 #include <assert.h>
 #include <array>
+#include <algorithm>
 #include "evalvalue.h"
 #include "move.h"
+#include "bits.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 namespace QaplaBasics {
 
@@ -103,12 +109,10 @@ namespace QaplaBasics {
 		 */
 		void dragMoveToTheBack(uint32_t departureIndex, uint32_t destinationIndex) {
 			assert(destinationIndex >= departureIndex);
-			Move tempMove = moveList[destinationIndex];
-			value_t tempWeight = moveWeights[destinationIndex];
-			for (uint32_t index = destinationIndex; index > departureIndex; index--) {
-				moveList[index] = moveList[index - 1];
-				moveWeights[index] = moveWeights[index - 1];
-			}
+			const Move tempMove = moveList[destinationIndex];
+			const value_t tempWeight = moveWeights[destinationIndex];
+			std::copy_backward(&moveList[departureIndex], &moveList[destinationIndex], &moveList[destinationIndex] + 1);
+			std::copy_backward(&moveWeights[departureIndex], &moveWeights[destinationIndex], &moveWeights[destinationIndex] + 1);
 			moveList[departureIndex] = tempMove;
 			moveWeights[departureIndex] = tempWeight;
 		}
@@ -116,15 +120,13 @@ namespace QaplaBasics {
 		/**
 		 * Gets the best amount moves and sorts them to the beginning of the silent moves list
 		 * Sorting is done by a kind of insertion sort (search the next best move and swaps it to the front).
+		 * Only moves with a positive weight are sorted, the others keep the generation order
 		 */
 		void sortFirstSilentMoves(uint32_t amount) {
 			for (uint32_t sortIndex = nonSilentMoveAmount; sortIndex < totalMoveAmount && amount > 0; sortIndex++, amount--) {
-				value_t moveWeight = 0;
-				uint32_t bestIndex = sortIndex;
-				for (uint32_t searchBestIndex = sortIndex; searchBestIndex < totalMoveAmount; searchBestIndex++) {
-					if (getWeight(searchBestIndex) > moveWeight) {
-						bestIndex = searchBestIndex;
-					}
+				const uint32_t bestIndex = findBestWeightIndex(sortIndex, totalMoveAmount);
+				if (getWeight(bestIndex) <= 0) {
+					break;
 				}
 				if (bestIndex != sortIndex) {
 					swapEntry(sortIndex, bestIndex);
@@ -132,9 +134,63 @@ namespace QaplaBasics {
 			}
 		}
 
+		/**
+		 * Gets the index of the move with the highest weight in [begin, end). On equal weights
+		 * the lowest index is returned. 
+		 * @returns index of the best move or end, if the range is empty
+		 */
+		uint32_t findBestWeightIndex(uint32_t begin, uint32_t end) const {
+			if (begin >= end) {
+				return end;
+			}
+			uint32_t index = begin;
+			value_t bestWeight = moveWeights[begin];
+#ifdef __AVX2__
+			if (end - begin >= AVX2_MIN_AMOUNT) {
+				// First pass: maximum of all weights, eight weights per step. The last step overlaps 
+				// the previous one, this does not change the maximum
+				const value_t* weights = moveWeights.data();
+				__m256i maxVector = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + end - AVX2_LANES));
+				for (; index + AVX2_LANES <= end; index += AVX2_LANES) {
+					maxVector = _mm256_max_epi32(maxVector, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + index)));
+				}
+				maxVector = _mm256_max_epi32(maxVector, _mm256_permute2x128_si256(maxVector, maxVector, 1));
+				maxVector = _mm256_max_epi32(maxVector, _mm256_shuffle_epi32(maxVector, _MM_SHUFFLE(1, 0, 3, 2)));
+				maxVector = _mm256_max_epi32(maxVector, _mm256_shuffle_epi32(maxVector, _MM_SHUFFLE(2, 3, 0, 1)));
+				// Second pass: first index holding the maximum
+				for (index = begin; index + AVX2_LANES <= end; index += AVX2_LANES) {
+					const __m256i compare = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + index)), maxVector);
+					const uint32_t mask = uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(compare)));
+					if (mask) {
+						return index + uint32_t(lsb(mask));
+					}
+				}
+				index = end - AVX2_LANES;
+				const __m256i compare = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + index)), maxVector);
+				return index + uint32_t(lsb(uint32_t(_mm256_movemask_ps(_mm256_castsi256_ps(compare)))));
+			}
+#endif
+			uint32_t bestIndex = begin;
+			for (index = begin + 1; index < end; index++) {
+				if (moveWeights[index] > bestWeight) {
+					bestWeight = moveWeights[index];
+					bestIndex = index;
+				}
+			}
+			return bestIndex;
+		}
+
 		// Gets a move from an index
 		Move getMove(uint32_t index) const { return moveList[index]; }
 
+		/**
+		 * Removes a move from the selection by emptying it and setting its weight below any selectable weight
+		 */
+		void setEmpty(uint32_t index) { 
+			moveList[index].setEmpty(); 
+			moveWeights[index] = EMPTY_WEIGHT;
+		}
+
 		Move operator[](uint32_t index) const { return moveList[index]; }
 		Move& operator[](uint32_t index) { return moveList[index]; }
 
@@ -157,11 +213,16 @@ namespace QaplaBasics {
 		}
 
 
+		// Weight of moves that must not be selected any more
+		static const value_t EMPTY_WEIGHT = -MAX_VALUE;
+
 	protected:
 		static const int32_t MAX_MOVE_AMOUNT = 200;
+		static const uint32_t AVX2_LANES = 8;
+		static const uint32_t AVX2_MIN_AMOUNT = 16;
 
-		array<Move, MAX_MOVE_AMOUNT> moveList;
-		array<value_t, MAX_MOVE_AMOUNT> moveWeights;
+		alignas(32) array<Move, MAX_MOVE_AMOUNT> moveList;
+		alignas(32) array<value_t, MAX_MOVE_AMOUNT> moveWeights;
 	public:
 		uint32_t totalMoveAmount;
 		uint32_t nonSilentMoveAmount;
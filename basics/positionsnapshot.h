@@ -0,0 +1,68 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Compact, trivially copyable snapshot of a chess position. Holds the piece bitboards,
+ * the side to move and the board state (castling rights, en passant, halfmove counters
+ * and hashes). Everything else (attack masks, material, piece square values, ...) is
+ * recomputed when a board is restored from the snapshot.
+ */
+
+#ifndef __POSITIONSNAPSHOT_H
+#define __POSITIONSNAPSHOT_H
+
+#include <array>
+#include <type_traits>
+#include "types.h"
+#include "boardstate.h"
+
+namespace QaplaBasics {
+
+	struct PositionSnapshot {
+
+		static constexpr uint32_t PIECE_BB_AMOUNT = PIECE_AMOUNT - MIN_PIECE;
+
+		/**
+		 * Gets the bitboard of a piece
+		 */
+		bitBoard_t getPieceBB(Piece piece) const { return pieceBB[piece - MIN_PIECE]; }
+
+		/**
+		 * Gets the hash of the position (identical to Board::computeBoardHash)
+		 */
+		hash_t computeBoardHash() const {
+			return boardState.computeBoardHash() ^ HashConstants::COLOR_RANDOMS[(int32_t)whiteToMove];
+		}
+
+		/**
+		 * Checks, if two snapshots hold the same pieces with the same side to move
+		 */
+		bool isIdenticalPosition(const PositionSnapshot& snapshot) const {
+			return whiteToMove == snapshot.whiteToMove && pieceBB == snapshot.pieceBB;
+		}
+
+		array<bitBoard_t, PIECE_BB_AMOUNT> pieceBB;
+		BoardState boardState;
+		bool whiteToMove;
+	};
+
+	static_assert(std::is_trivially_copyable<PositionSnapshot>::value, "PositionSnapshot must be trivially copyable");
+	static_assert(sizeof(PositionSnapshot) <= 200, "PositionSnapshot shall stay compact");
+
+}
+
+#endif // __POSITIONSNAPSHOT_H
@@ -285,7 +285,8 @@ namespace QaplaBitbase {
 
         _bitbase.resize(expectedSize);
         std::memcpy(_bitbase.data(), decompressed.data(), decompressed.size());
-        _loaded = true;
+        // The embedded data is the complete bitbase, thus it needs no header from a file
+        setLoaded();
 
         if (verbose) {
             cout << "Bitbase loaded from embedded data, sizeInBit = " << _sizeInBits << endl;
@@ -19,6 +19,8 @@
 
 #include <string>
 #include <iomanip>
+#include <thread>
+#include <atomic>
 #include "eval.h"
 #include "evalendgame.h"
 #include "pawn.h"
@@ -29,12 +31,12 @@
 #include "king-attack.h"
 #include "king.h"
 #include "threat.h"
+#include "signature-correction.h"
 //#include "eval-correction.h"
 
 using namespace ChessEval;
 
-std::vector<PieceInfo> Eval::fetchDetails(MoveGenerator& position) {
-	EvalResults evalResults;
+std::vector<PieceInfo> Eval::fetchDetails(MoveGenerator& position, EvalResults& evalResults) {
 	initEvalResults(position, evalResults);
 	evalResults.midgameInPercent = computeMidgameInPercent(position);
 	evalResults.midgameInPercentV2 = computeMidgameV2InPercent(position);
@@ -64,27 +66,65 @@ std::vector<PieceInfo> Eval::fetchDetails(MoveGenerator& position) {
 	return details;
 }
 
-IndexVector Eval::computeIndexVector(MoveGenerator& position) {
+IndexVector Eval::computeIndexVector(MoveGenerator& position, bool allFeatures) {
 	IndexVector indexVector;
 	uint32_t sig = position.getPiecesSignature();
 	indexVector.push_back(IndexInfo{ "pieceSignature", sig, NO_PIECE });
-	return indexVector;
+	if (!allFeatures) return indexVector;
 	EvalResults evalResults;
 	indexVector.push_back(IndexInfo{ "midgame", uint32_t(computeMidgameInPercent(position)), NO_PIECE });
 	indexVector.push_back(IndexInfo{ "midgamev2", uint32_t(computeMidgameV2InPercent(position)), NO_PIECE });
 	indexVector.push_back(IndexInfo{ "tempo", 0, position.isWhiteToMove() ? WHITE : BLACK });
 	indexVector.push_back({ "kingPST", uint32_t(position.getKingSquare<WHITE>()), WHITE });
 	indexVector.push_back({ "kingPST", uint32_t(switchSide(position.getKingSquare<BLACK>())), BLACK });
-	const std::vector<PieceInfo> details = fetchDetails(position);
+	const std::vector<PieceInfo> details = fetchDetails(position, evalResults);
 	for (const auto& piece : details) {
 		indexVector.insert(indexVector.end(), piece.indexVector.begin(), piece.indexVector.end());
 	}
-	KingAttack::eval(position, evalResults);
 	KingAttack::addToIndexVector(evalResults, indexVector);
 	Threat::addToIndexVector(position, evalResults, indexVector);
 	return indexVector;
 }
 
+std::vector<BatchEvalResult> Eval::evalBatch(const std::vector<PositionSnapshot>& positions, 
+	uint32_t threadCount, bool computeIndices) 
+{
+	constexpr size_t CHUNK_SIZE = 256;
+	constexpr int32_t PAWN_TT_SIZE_IN_KILOBYTES = 1024;
+	std::vector<BatchEvalResult> results(positions.size());
+	std::atomic<size_t> nextChunk = 0;
+	threadCount = std::max<uint32_t>(1, std::min<uint32_t>(threadCount, 
+		uint32_t((positions.size() + CHUNK_SIZE - 1) / CHUNK_SIZE)));
+
+	auto worker = [&]() {
+		MoveGenerator position;
+		PawnTT pawnTT;
+		pawnTT.setSizeInKilobytes(PAWN_TT_SIZE_IN_KILOBYTES);
+		Eval evaluator;
+		for (size_t begin = nextChunk.fetch_add(CHUNK_SIZE); begin < positions.size(); begin = nextChunk.fetch_add(CHUNK_SIZE)) {
+			const size_t end = std::min(begin + CHUNK_SIZE, positions.size());
+			for (size_t index = begin; index < end; index++) {
+				position.setFromSnapshot(positions[index]);
+				const value_t value = lazyEval<false>(position, 0, &pawnTT);
+				results[index].value = position.isWhiteToMove() ? value : -value;
+				if (computeIndices) {
+					results[index].indexVector = evaluator.computeIndexVector(position, true);
+				}
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (uint32_t threadNo = 1; threadNo < threadCount; threadNo++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	return results;
+}
+
 IndexLookupMap Eval::computeIndexLookupMap(MoveGenerator& position) {
 	IndexLookupMap indexLookup = Pawn::getIndexLookup();
 	indexLookup.merge(Knight::getIndexLookup());
@@ -93,20 +133,40 @@ IndexLookupMap Eval::computeIndexLookupMap(MoveGenerator& position) {
 	indexLookup.merge(Queen::getIndexLookup());
 	indexLookup.merge(KingAttack::getIndexLookup());
 	indexLookup.merge(Threat::getIndexLookup());
+	indexLookup.merge(King::getIndexLookup());
 	const auto& pieceValues = position.getPieceValues();
 	indexLookup["material"] = std::vector<EvalValue>{ pieceValues.begin(), pieceValues.end() };
-	indexLookup["kingPST"] = PST::getPSTLookup(KING);
 	indexLookup["tempo"] = std::vector<EvalValue>{ EvalValue(tempo) };
 	return indexLookup;
 }
 
+template <uint32_t PIECES>
+EvalValue Eval::evalPieces(MoveGenerator& position, EvalResults& evalResults) {
+	EvalValue evalValue;
+	// Do not change ordering of the following calls. King attack needs result from Mobility
+	if constexpr ((PIECES & PIECES_ROOK) != 0) evalValue += Rook::eval(position, evalResults);
+	if constexpr ((PIECES & PIECES_BISHOP) != 0) evalValue += Bishop::eval(position, evalResults);
+	if constexpr ((PIECES & PIECES_KNIGHT) != 0) evalValue += Knight::eval(position, evalResults);
+	if constexpr ((PIECES & PIECES_QUEEN) != 0) evalValue += Queen::eval(position, evalResults);
+	evalValue += Threat::eval(position, evalResults);
+	evalValue += Pawn::evalPassedPawnThreats(position, evalResults);
+	evalValue += King::eval(position, evalResults);
+	if constexpr ((PIECES & PIECES_KING_ATTACK) != 0) evalValue += KingAttack::eval(position, evalResults);
+	return evalValue;
+}
+
+const std::array<Eval::evalPiecesFunction_t, Eval::PIECES_VARIANTS> Eval::evalPiecesTable = 
+	Eval::createEvalPiecesTable(std::make_index_sequence<Eval::PIECES_VARIANTS>());
+
  /**
   * Calculates an evaluation for the current board position
   * The result is a value from the view of white, thus positive values are better for white
   * negative values better for black.
  */
 template <bool PRINT>
-value_t Eval::lazyEval(MoveGenerator& position,value_t ply, PawnTT* pawnttPtr) {
+value_t Eval::lazyEval(MoveGenerator& position,value_t ply, PawnTT* pawnttPtr, 
+	value_t alpha, value_t beta, EvalStageStatistic* statistic) 
+{
 
 	value_t result = 0;
 	EvalResults evalResults;
@@ -121,23 +181,28 @@ value_t Eval::lazyEval(MoveGenerator& position,value_t ply, PawnTT* pawnttPtr) {
 	// Add paw value to the evaluation
 	evalValue += Pawn::eval(position, evalResults, pawnttPtr);
 
+	// As the former EVAL_CORRECTION table: half of the adjuster's value and only for the eval version under test
+	const value_t signatureCorrection = position.getEvalVersion() == 1 
+		? SignatureCorrection::get(position.getPiecesSignature()) / 2 : 0;
+
+	// Stage 1: material, piece square tables, pawns and the signature correction only
+	if (statistic != nullptr) {
+		result = evalValue.getValue(evalResults.midgameInPercentV2) + signatureCorrection
+			+ (position.isWhiteToMove() ? tempo : -tempo);
+		if (isLazyExit(position, result, alpha, beta)) {
+			statistic->materialStageExits++;
+			return result == 0 ? 1 : result;
+		}
+		statistic->fullEvals++;
+		result = 0;
+	}
+
 	// Try endgame evaluation first. If it returns a modified value, use it.
 	// This indicates a known endgame pattern was recognized.
 	// Otherwise, continue the standard evaluation
 
 
-	// Do not change ordering of the following calls. King attack needs result from Mobility
-	evalValue += Rook::eval(position, evalResults);
-	evalValue += Bishop::eval(position, evalResults);
-	evalValue += Knight::eval(position, evalResults);
-	evalValue += Queen::eval(position, evalResults);
-	evalValue += Threat::eval(position, evalResults);
-	evalValue += Pawn::evalPassedPawnThreats(position, evalResults);
-	evalValue += King::eval(position, evalResults);
-
-	if (evalResults.midgameInPercent > 0) {
-		evalValue += KingAttack::eval(position, evalResults);
-	}
+	evalValue += evalPiecesTable[computeEvalPiecesIndex(position, evalResults.midgameInPercent)](position, evalResults);
 
 	result += evalValue.getValue(evalResults.midgameInPercentV2);
 
@@ -150,11 +215,7 @@ value_t Eval::lazyEval(MoveGenerator& position,value_t ply, PawnTT* pawnttPtr) {
 			<< std::right << std::setw(19) << result << std::endl;
 	}
 
-	/*
-	if (position.getEvalVersion() == 1) {
-		result += EVAL_CORRECTION[position.getPiecesSignature()] / 2;
-	}
-	*/
+	result += signatureCorrection;
 	if constexpr (PRINT) {
 		cout << "Piece Signature Correction:"
 			<< std::right << std::setw(9) << result << std::endl;
@@ -179,7 +240,10 @@ value_t Eval::lazyEval(MoveGenerator& position,value_t ply, PawnTT* pawnttPtr) {
 		const value_t randomBonus = position.getRandomBonus();
 		if (randomBonus != 0) {
 			result += randomBonus;
-			result += rand() % (2 * randomBonus + 1) - randomBonus;
+			uint64_t random = position.computeBoardHash() ^ position.getRandomSeed();
+			random = (random ^ (random >> 33)) * 0xFF51AFD7ED558CCDULL;
+			random ^= random >> 29;
+			result += value_t(random % uint64_t(2 * randomBonus + 1)) - randomBonus;
 			if constexpr (PRINT) {
 				cout << "Random bonus:"
 					<< std::right << std::setw(20) << result << std::endl;
@@ -208,6 +272,13 @@ value_t Eval::lazyEval(MoveGenerator& position,value_t ply, PawnTT* pawnttPtr) {
 	return result;
 }
 
+bool Eval::isLazyExit(const MoveGenerator& position, value_t value, value_t alpha, value_t beta) {
+	if (value + LAZY_EVAL_MARGIN > alpha && value - LAZY_EVAL_MARGIN < beta) return false;
+	if (position.getRandomBonus() != 0) return false;
+	if (position.getTotalHalfmovesWithoutPawnMoveOrCapture() > 20) return false;
+	return !EvalEndgame::hasEntry(position);
+}
+
 void Eval::printEvalBoard(const std::vector<PieceInfo>& details, value_t midgameInPercent) {
 	// berschrift
 	constexpr auto WIDTH = 11;
@@ -283,8 +354,8 @@ void  Eval::printPieceRow(int row, const PieceInfo& pieceInfo, value_t midgameIn
 void Eval::initEvalResults(MoveGenerator& position, EvalResults& evalResults) {
 	evalResults.queensBB = position.getPieceBB(WHITE_QUEEN) | position.getPieceBB(BLACK_QUEEN);
 	evalResults.pawnsBB = position.getPieceBB(WHITE_PAWN) | position.getPieceBB(BLACK_PAWN);
-	evalResults.piecesAttack[WHITE] = evalResults.piecesAttack[BLACK] = 0;
-	evalResults.piecesDoubleAttack[WHITE] = evalResults.piecesDoubleAttack[BLACK] = 0;
+	// Attacks of piece types skipped by evalPieces must read as empty
+	evalResults.clearAttacksBB();
 	position.computePinnedMask<WHITE>();
 	position.computePinnedMask<BLACK>();
 }
@@ -297,6 +368,8 @@ void Eval::printEval(MoveGenerator& position) {
 	cout << "Total:" << std::right << std::setw(30) << evalValue << endl;
 }
 
-template value_t Eval::lazyEval<true>(MoveGenerator& position, value_t ply, PawnTT* pawnttPtr);
-template value_t Eval::lazyEval<false>(MoveGenerator& position, value_t ply, PawnTT* pawnttPtr);
+template value_t Eval::lazyEval<true>(MoveGenerator& position, value_t ply, PawnTT* pawnttPtr, 
+	value_t alpha, value_t beta, EvalStageStatistic* statistic);
+template value_t Eval::lazyEval<false>(MoveGenerator& position, value_t ply, PawnTT* pawnttPtr, 
+	value_t alpha, value_t beta, EvalStageStatistic* statistic);
 
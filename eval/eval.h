@@ -28,6 +28,7 @@
 
 #include <vector>
 #include <map>
+#include <utility>
 #include "../basics/types.h"
 #include "../movegenerator/movegenerator.h"
 #include "evalresults.h"
@@ -37,6 +38,31 @@ using namespace QaplaMoveGenerator;
 
 namespace ChessEval {
 
+	/**
+	 * Result of a batch evaluation for one position
+	 */
+	struct BatchEvalResult {
+		// Evaluation from the view of the side to move
+		value_t value;
+		// Feature indices, only filled on request
+		IndexVector indexVector;
+	};
+
+	/**
+	 * Counts, after which stage the staged evaluation returned
+	 */
+	struct EvalStageStatistic {
+		// Returned after material, piece square tables and pawns
+		uint64_t materialStageExits = 0;
+		// Computed the full evaluation
+		uint64_t fullEvals = 0;
+
+		void clear() {
+			materialStageExits = 0;
+			fullEvals = 0;
+		}
+	};
+
 	class Eval {
 
 	public:
@@ -70,20 +96,52 @@ namespace ChessEval {
 #endif
 		}
 
+		/**
+		 * Staged evaluation for the quiescence search. Returns after material, piece square tables
+		 * and pawns, if this value is more than LAZY_EVAL_MARGIN outside [alpha, beta]. Mobility, 
+		 * threats and king safety are only computed otherwise. 
+		 * alpha, beta and the result are from the view of the side to move.
+		 */
+		static value_t evalInWindow(MoveGenerator& position, PawnTT* pawnttPtr, value_t ply, 
+			value_t alpha, value_t beta, EvalStageStatistic& statistic) {
+#ifdef USE_STOCKFISH_EVAL
+			return Stockfish::Engine::evaluate();
+#else
+			return position.isWhiteToMove() ?
+				lazyEval<false>(position, ply, pawnttPtr, alpha, beta, &statistic) :
+				-lazyEval<false>(position, ply, pawnttPtr, -beta, -alpha, &statistic);
+#endif
+		}
+
 		/**
 		 * Prints the evaluation results
 		 */
 		static void printEval(MoveGenerator& position);
 
+		static const value_t LAZY_EVAL_MARGIN = 300;
+
 		/**
 		 * Fetches the list of indices calculated by the evaluation
+		 * @param allFeatures false: only the piece signature, true: additionally the game phase 
+		 * and every eval feature (used for tuning)
 		 */
-		IndexVector computeIndexVector(MoveGenerator& position);
+		IndexVector computeIndexVector(MoveGenerator& position, bool allFeatures = false);
 		/**
 		 * Fetches the lookup map to get the value of an index value
 		 */
 		IndexLookupMap computeIndexLookupMap(MoveGenerator& position);
 
+		/**
+		 * Evaluates a batch of positions in parallel. Every thread uses its own board and 
+		 * pawn hash, positions are handed out in chunks. Always uses the native evaluation.
+		 * @param positions compact positions to evaluate
+		 * @param threadCount amount of threads to use (at least one)
+		 * @param computeIndices true, to additionally compute the feature index vector of each position
+		 * @returns one result per position in the order of the input
+		 */
+		static std::vector<BatchEvalResult> evalBatch(const std::vector<PositionSnapshot>& positions, 
+			uint32_t threadCount, bool computeIndices = false);
+
 
 	private:
 
@@ -115,14 +173,68 @@ namespace ChessEval {
 
 		/**
 		 * Calculates an evaluation for the current board position
+		 * With a statistic, it returns after the first stage, if the value is far outside [alpha, beta]. 
+		 * alpha and beta are from the view of white.
 		 */
 		template <bool PRINT>
-		static value_t lazyEval(MoveGenerator& position, value_t ply, PawnTT* pawnttPtr = nullptr);
+		static value_t lazyEval(MoveGenerator& position, value_t ply, PawnTT* pawnttPtr = nullptr,
+			value_t alpha = -MAX_VALUE, value_t beta = MAX_VALUE, EvalStageStatistic* statistic = nullptr);
+
+		/**
+		 * Checks, if the first stage value is far enough outside the window to skip the remaining stages.
+		 * Positions with endgame knowledge or a value scaled by the fifty moves rule are always fully evaluated.
+		 */
+		static bool isLazyExit(const MoveGenerator& position, value_t value, value_t alpha, value_t beta);
+
+		/**
+		 * Evaluates the piece terms, threats, king and king attack.
+		 * PIECES holds a PIECES_* bit for every piece type on the board. Terms of missing 
+		 * piece types and the king attack without KING_ATTACK are removed at compile time
+		 */
+		template <uint32_t PIECES>
+		static EvalValue evalPieces(MoveGenerator& position, EvalResults& evalResults);
+
+		/**
+		 * Computes the evalPieces variant matching the pieces on board and the game phase
+		 */
+		static uint32_t computeEvalPiecesIndex(const MoveGenerator& position, value_t midgameInPercent) {
+			const pieceSignature_t signature = position.getPiecesSignature();
+			const pieceSignature_t bothColors = signature | (signature >> PieceSignature::SIG_SHIFT_BLACK);
+			uint32_t index = 0;
+			if (bothColors & SignatureMask::KNIGHT) index |= PIECES_KNIGHT;
+			if (bothColors & SignatureMask::BISHOP) index |= PIECES_BISHOP;
+			if (bothColors & SignatureMask::ROOK) index |= PIECES_ROOK;
+			if (bothColors & SignatureMask::QUEEN) index |= PIECES_QUEEN;
+			if (midgameInPercent > 0) index |= PIECES_KING_ATTACK;
+			return index;
+		}
+
+		static const uint32_t PIECES_KNIGHT = 1;
+		static const uint32_t PIECES_BISHOP = 2;
+		static const uint32_t PIECES_ROOK = 4;
+		static const uint32_t PIECES_QUEEN = 8;
+		static const uint32_t PIECES_KING_ATTACK = 16;
+		static const uint32_t PIECES_VARIANTS = 32;
+
+		typedef EvalValue(*evalPiecesFunction_t)(MoveGenerator& position, EvalResults& evalResults);
+
+		template <size_t... INDEX>
+		static constexpr std::array<evalPiecesFunction_t, sizeof...(INDEX)> createEvalPiecesTable(std::index_sequence<INDEX...>) {
+			return { &evalPieces<uint32_t(INDEX)>... };
+		}
+
+		// evalPieces variants indexed by computeEvalPiecesIndex
+		static const std::array<evalPiecesFunction_t, PIECES_VARIANTS> evalPiecesTable;
 
 		/**
 		 * Fetches details for the evaluation
+		 * @param evalResults receives the attack masks computed by the piece evaluations
 		 */
-		static std::vector<PieceInfo> fetchDetails(MoveGenerator& position);
+		static std::vector<PieceInfo> fetchDetails(MoveGenerator& position, EvalResults& evalResults);
+		static std::vector<PieceInfo> fetchDetails(MoveGenerator& position) {
+			EvalResults evalResults;
+			return fetchDetails(position, evalResults);
+		}
 
 
 		/**
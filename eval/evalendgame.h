@@ -74,6 +74,13 @@ namespace ChessEval {
 				: currentValue + entry.value;
 		}
 
+		/**
+		 * Checks, if a specialized endgame evaluation is registered for the piece signature of the board
+		 */
+		static bool hasEntry(const MoveGenerator& board) {
+			return pieceSignatureHash.lookup(board.getPiecesSignature()).has_value();
+		}
+
 		/**
 		 * Registers the use of a bitbase
 		 */
@@ -0,0 +1,164 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Dense integer representation of the eval features for tuning. The layout places all
+ * tables of an IndexLookupMap one after another in a single weight vector. A feature
+ * is then the offset of its table plus its index inside the table, so the tuning loops
+ * index a flat array instead of looking up the table name in a map for every feature.
+ */
+
+#ifndef __FEATURE_LAYOUT_H
+#define __FEATURE_LAYOUT_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include "../basics/types.h"
+#include "../basics/evalvalue.h"
+#include "eval-exchange-structures.h"
+
+using namespace QaplaBasics;
+
+namespace ChessEval {
+
+	struct FeatureInfo {
+		// Index into the dense weight vector
+		uint32_t id;
+		Piece color;
+	};
+
+	struct FeatureVector {
+		// Game phase used to interpolate the midgame/endgame weights
+		value_t midgameV2InPercent = 0;
+		std::vector<FeatureInfo> features;
+	};
+
+	class FeatureLayout {
+	public:
+		/**
+		 * Creates the layout from the table names and sizes of a lookup map
+		 */
+		explicit FeatureLayout(const IndexLookupMap& lookupMap) {
+			uint32_t offset = 0;
+			for (const auto& [name, values] : lookupMap) {
+				_names.push_back(name);
+				_offsets.push_back(offset);
+				_offsetByName[name] = offset;
+				offset += uint32_t(values.size());
+			}
+			_size = offset;
+		}
+
+		/**
+		 * Amount of weights of all tables
+		 */
+		uint32_t size() const { return _size; }
+
+		/**
+		 * Copies the tables of a lookup map to a dense weight vector
+		 */
+		std::vector<EvalValue> flatten(const IndexLookupMap& lookupMap) const {
+			std::vector<EvalValue> weights(_size);
+			for (size_t table = 0; table < _names.size(); table++) {
+				const auto& values = lookupMap.at(_names[table]);
+				std::copy(values.begin(), values.end(), weights.begin() + _offsets[table]);
+			}
+			return weights;
+		}
+
+		/**
+		 * Splits a dense vector back into named tables, e.g. for printing
+		 */
+		template <typename T>
+		std::map<std::string, std::vector<T>> unflatten(const std::vector<T>& weights) const {
+			std::map<std::string, std::vector<T>> result;
+			for (size_t table = 0; table < _names.size(); table++) {
+				const uint32_t end = table + 1 < _offsets.size() ? _offsets[table + 1] : _size;
+				result[_names[table]] = std::vector<T>(weights.begin() + _offsets[table], weights.begin() + end);
+			}
+			return result;
+		}
+
+		/**
+		 * Converts the string based index vector of a position to feature ids.
+		 * The game phase entries are moved to midgameV2InPercent, entries without a table are dropped
+		 */
+		FeatureVector toFeatureVector(const IndexVector& indexVector) const {
+			FeatureVector result;
+			result.features.reserve(indexVector.size());
+			for (const auto& indexInfo : indexVector) {
+				if (indexInfo.name == "midgamev2") {
+					result.midgameV2InPercent = value_t(indexInfo.index);
+					continue;
+				}
+				const auto it = _offsetByName.find(indexInfo.name);
+				if (it == _offsetByName.end()) continue;
+				result.features.push_back(FeatureInfo{ it->second + indexInfo.index, indexInfo.color });
+			}
+			return result;
+		}
+
+		/**
+		 * Computes a hash of the table names and sizes, used to detect files written 
+		 * with a different layout
+		 */
+		uint64_t computeHash() const {
+			// FNV-1a
+			uint64_t hash = 0xcbf29ce484222325ULL;
+			auto add = [&hash](uint64_t value) {
+				hash ^= value;
+				hash *= 0x100000001b3ULL;
+			};
+			for (size_t table = 0; table < _names.size(); table++) {
+				for (const char ch : _names[table]) {
+					add(uint8_t(ch));
+				}
+				add(_offsets[table]);
+			}
+			add(_size);
+			return hash;
+		}
+
+		/**
+		 * Gets the name of the table holding a feature id
+		 */
+		const std::string& getName(uint32_t id) const {
+			const auto it = std::upper_bound(_offsets.begin(), _offsets.end(), id);
+			return _names[it - _offsets.begin() - 1];
+		}
+
+		/**
+		 * Gets the index of a feature id inside its table
+		 */
+		uint32_t getIndex(uint32_t id) const {
+			const auto it = std::upper_bound(_offsets.begin(), _offsets.end(), id);
+			return id - *(it - 1);
+		}
+
+	private:
+		std::vector<std::string> _names;
+		std::vector<uint32_t> _offsets;
+		std::unordered_map<std::string, uint32_t> _offsetByName;
+		uint32_t _size;
+	};
+
+}
+
+#endif // __FEATURE_LAYOUT_H
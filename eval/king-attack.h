@@ -44,7 +44,7 @@ namespace ChessEval {
 		static IndexLookupMap getIndexLookup() {
 			IndexLookupMap indexLookup;
 			std::vector<EvalValue> attack;
-			for (auto weight : attackWeight) {
+			for (auto weight : attackWeight2) {
 				attack.push_back(EvalValue(weight, 0));
 			}
 			indexLookup["kAttack"] = attack;
@@ -119,10 +119,10 @@ namespace ChessEval {
 		inline static value_t computeCheckMoves(const MoveGenerator& position, EvalResults& results) {
 			const Piece OPPONENT = switchColor(COLOR);
 			Square kingSquare = position.getKingSquare<COLOR>();
-			bitBoard_t allPieces = position.getAllPiecesBB();
 			bitBoard_t kingAttack = BitBoardMasks::kingMoves[kingSquare];
-			bitBoard_t bishopChecks = Magics::genBishopAttackMask(kingSquare, allPieces);
-			bitBoard_t rookChecks = Magics::genRookAttackMask(kingSquare, allPieces);
+			const KingRays& kingRays = position.getKingRays<COLOR>();
+			bitBoard_t bishopChecks = kingRays.bishop;
+			bitBoard_t rookChecks = kingRays.rook;
 			bitBoard_t knightChecks = BitBoardMasks::knightMoves[kingSquare];
 
 			bishopChecks &= results.queenAttack[OPPONENT] | results.bishopAttack[OPPONENT];
@@ -169,7 +169,7 @@ namespace ChessEval {
 			//attackValue += (pawnIndexFactor[pawnShieldIndex] * results.midgameInPercentV2) / 100;
 
 			if constexpr (STORE_DETAILS) {
-				const IndexVector indexVector{ { "kingAttack", attackIndex, COLOR } };
+				const IndexVector indexVector{ { "kAttack", attackIndex, COLOR } };
 				details->push_back({ KING + COLOR, kingSquare, indexVector, "a<" + std::to_string(attackIndex) + ">", COLOR == WHITE ? attackValue : -attackValue });
 			}
 			
@@ -48,7 +48,8 @@ namespace ChessEval {
 
 		static IndexLookupMap getIndexLookup() {
 			IndexLookupMap indexLookup;
-			indexLookup["kPST"] = PST::getPSTLookup(KNIGHT);
+			indexLookup["kingPST"] = PST::getPSTLookup(KING);
+			indexLookup["kingDistance"] = std::vector<EvalValue>(KING_DISTANCE_MAP.begin(), KING_DISTANCE_MAP.end());
 			return indexLookup;
 		}
 
@@ -95,13 +96,14 @@ namespace ChessEval {
 		static EvalValue evalColor(const MoveGenerator& position, EvalResults& results, std::vector<PieceInfo>* details) {
 			const Square kingSquare = position.getKingSquare<COLOR>();
 			const value_t kingDistance = minDistance(kingSquare, position.getPieceBB(PAWN + COLOR));
-			const EvalValue propertyValue = EvalValue(0, kingDistance * DISTANCE_PENALTY);
+			const EvalValue propertyValue = KING_DISTANCE_MAP[kingDistance];
 			if constexpr (STORE_DETAILS) {
 				const auto materialValue = 0;
 				const auto pstValue = PST::getValue(kingSquare, KING + COLOR);
 				const auto mobility = 0;
 				const auto property = COLOR == WHITE ? propertyValue : -propertyValue;
-				details->push_back({ KING + COLOR, kingSquare, {}, "", property + pstValue });
+				const IndexVector indexVector{ { "kingDistance", uint32_t(kingDistance), COLOR } };
+				details->push_back({ KING + COLOR, kingSquare, indexVector, "", property + pstValue });
 			}
 			return propertyValue;
 		}
@@ -122,7 +124,10 @@ namespace ChessEval {
 			return result;
 		}();
 
-		static const value_t DISTANCE_PENALTY = -10;
+		// Endgame penalty by the distance of the king to the nearest own pawn
+		static constexpr std::array<EvalValue, 7> KING_DISTANCE_MAP = { {
+			{ 0, 0 }, { 0, -10 }, { 0, -20 }, { 0, -30 }, { 0, -40 }, { 0, -50 }, { 0, -60 }
+		} };
 	};
 }
 
@@ -93,7 +93,7 @@ namespace ChessEval {
 			IndexLookupMap indexLookup;
 			indexLookup["pProperty"] = std::vector<EvalValue>{ evalValueMap.begin(), evalValueMap.end() };
 			indexLookup["pPST"] = PST::getPSTLookup(PAWN);
-			indexLookup["ppThreat"] = std::vector<EvalValue>{ ppThreatMap.begin(), ppThreatMap.end() };
+			indexLookup["ppThreat"] = std::vector<EvalValue>(ppThreatMap.begin(), ppThreatMap.end());
 			return indexLookup;
 		}
 
@@ -150,13 +150,8 @@ namespace ChessEval {
 			}
 			hash_t key = position.getPawnHash();
 			if (key == NO_PAWNS_KEY) return NO_VALUE;
-			uint32_t index = pawnttPtr->getTTEntryIndex(key);
-			if (index != pawnttPtr->INVALID_INDEX) {
-				const PawnTTEntry& entry = pawnttPtr->getEntry(index);
-				if (!entry.isEmpty()) {
-					results.passedPawns = entry._passedPawns;
-					value = EvalValue(entry._mgValue, entry._egValue);
-				}
+			if (!pawnttPtr->probe(key, value, results.passedPawns)) {
+				return NO_VALUE;
 			}
 			return value;
 		}
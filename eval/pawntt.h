@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <iterator>
+#include <algorithm>
 #include "../basics/hashconstants.h"
 #include "../basics/evalvalue.h"
 
@@ -31,29 +32,50 @@ using namespace std;
 using namespace QaplaBasics;
 
 namespace ChessEval {
+
+	/**
+	 * Pawn hash entry. The key is stored xor-ed with the payload so that an entry
+	 * torn by concurrent writers is rejected on read instead of returning mixed data.
+	 */
 	struct PawnTTEntry {
-		int16_t _mgValue;
-		int16_t _egValue;
-		hash_t _hash;
+		hash_t _check;
+		uint64_t _value;
 		colorBB_t _passedPawns;
 
-		void setEmpty() { _hash = 0; }
-		bool isEmpty() const { return _hash == 0; }
+		void setEmpty() { _check = 0; _value = 0; _passedPawns = { 0, 0 }; }
+
 		void set(hash_t hash, EvalValue value, colorBB_t passedPawns) {
-			_hash = hash;
-			_mgValue = static_cast<int16_t>(value.midgame());
-			_egValue = static_cast<int16_t>(value.endgame());
+			_value = packValue(value);
 			_passedPawns = passedPawns;
+			_check = hash ^ computePayloadHash(_value, passedPawns);
+		}
+
+		/**
+		 * Gets the hash key this entry was stored with (only valid, if the entry is not torn)
+		 */
+		hash_t getHash() const {
+			return _check ^ computePayloadHash(_value, _passedPawns);
 		}
+
 		EvalValue getValue() const {
-			return EvalValue(_mgValue, _egValue);
+			return EvalValue(int16_t(_value & 0xFFFF), int16_t((_value >> 16) & 0xFFFF));
+		}
+
+	private:
+		static uint64_t packValue(EvalValue value) {
+			return uint64_t(uint16_t(int16_t(value.midgame()))) | (uint64_t(uint16_t(int16_t(value.endgame()))) << 16);
+		}
+
+		static hash_t computePayloadHash(uint64_t value, const colorBB_t& passedPawns) {
+			return value ^ passedPawns[WHITE] ^ passedPawns[BLACK];
 		}
 	};
+
 	class PawnTT
 	{
 	public:
 
-		PawnTT() { clear(); }
+		PawnTT() : _mask(0), _probes(0), _hits(0) { clear(); }
 
 		/**
 		 * Clears the transposition table
@@ -63,102 +85,89 @@ namespace ChessEval {
 			for (PawnTTEntry& entry : _tt) {
 				entry.setEmpty();
 			}
+			clearStatistic();
 		}
 
 		/**
 		 * Gets the size of the transposition table in bytes
 		 */
-		size_t getSizeInBytes() { 
-			return _tt.capacity() * sizeof(PawnTTEntry);
+		size_t getSizeInBytes() const { 
+			return _tt.size() * sizeof(PawnTTEntry);
 		}
 
 		/**
 		 * Computes the hash index of a hash key 
 		 */
-		int32_t	computeEntryIndex(hash_t hashKey) {
-			return int32_t(hashKey % _tt.capacity());
+		inline uint32_t computeEntryIndex(hash_t hashKey) const {
+			return uint32_t(hashKey & _mask);
 		}
 
 		/**
 		 * Resizes the tt so that it has a certain amount of kilobytes
+		 * The amount of entries is rounded down to a power of two
 		 */
 		void setSizeInKilobytes(int32_t sizeInKiloBytes)
 		{
-			uint64_t newCapacitiy = ( 1024ULL * sizeInKiloBytes) / sizeof(PawnTTEntry);
-			setCapacity(newCapacitiy);
+			uint64_t maxCapacity = (1024ULL * std::max(sizeInKiloBytes, 1)) / sizeof(PawnTTEntry);
+			uint64_t newCapacity = 1;
+			while (newCapacity * 2 <= maxCapacity) {
+				newCapacity *= 2;
+			}
+			setCapacity(newCapacity);
 		}
 
 		/**
 		 * Sets a hash entry 
 		 */
-		uint32_t setEntry(hash_t hashKey, EvalValue value, colorBB_t passedPawns)
+		void setEntry(hash_t hashKey, EvalValue value, colorBB_t passedPawns)
 		{
-			uint32_t index = computeEntryIndex(hashKey);
-			_tt[index].set(hashKey, value, passedPawns);
-			return index;
+			_tt[computeEntryIndex(hashKey)].set(hashKey, value, passedPawns);
 		}
 
 		/**
-		 * Gets a valid tt entry index
-		 * @returns tt entry index with the correct hash signature or INVALID_INDEX
+		 * Probes the table for a hash key
+		 * @returns true, if a verified entry is found. value and passedPawns are set only in this case
 		 */
-		uint32_t getTTEntryIndex(hash_t hashKey)
-		{
-			uint32_t index = computeEntryIndex(hashKey);
-			return _tt[index]._hash == hashKey ? index : INVALID_INDEX;
-		}
-
-		/**
-		 * Gets a element by index
-		 */
-		inline const PawnTTEntry& getEntry(uint32_t index) const {
-			return _tt[index];
-		}
-
-		/**
-	     * Gets a element by index
-		 */
-		inline PawnTTEntry& getEntry(uint32_t index) {
-			return _tt[index];
-		}
-
-		inline value_t getValue2(uint32_t index) const {
-			return _tt[index]._mgValue;
-		}
-
-		inline EvalValue getValue(uint32_t index) const {
-			return _tt[index].getValue();
+		bool probe(hash_t hashKey, EvalValue& value, colorBB_t& passedPawns) {
+			_probes++;
+			const PawnTTEntry entry = _tt[computeEntryIndex(hashKey)];
+			if (entry.getHash() != hashKey) {
+				return false;
+			}
+			_hits++;
+			value = entry.getValue();
+			passedPawns = entry._passedPawns;
+			return true;
 		}
 
-
 		/**
-		 * Calculates an optimized amount of entries
+		 * Resets the probe and hit counters
 		 */
-		int32_t optimizeHashEntryAmount(int32_t sizeInKiloBytes)
-		{
-			int32_t newEntryAmount = sizeInKiloBytes * (1024 / sizeof(PawnTTEntry));
-			if (newEntryAmount % 2 == 1) newEntryAmount--;
-			if (newEntryAmount < 16) {
-				newEntryAmount = 16;
-			}
-			return newEntryAmount;
+		void clearStatistic() {
+			_probes = 0;
+			_hits = 0;
 		}
 
-		static const uint32_t INVALID_INDEX = UINT32_MAX;
+		uint64_t getProbes() const { return _probes; }
+		uint64_t getHits() const { return _hits; }
 
 	private:
 
 		/**
-		 * Sets the transposition table capacity
+		 * Sets the transposition table capacity, must be a power of two
 		 */
 		void setCapacity(uint64_t newCapacity) {
-			// _tt.reserve(newCapacity);
 			_tt.resize(newCapacity);
+			_mask = newCapacity - 1;
 			clear();
 		}
 
 		// Transposition table
 		vector<PawnTTEntry> _tt;
+		hash_t _mask;
+		// Statistic, only approximate, if the table is shared between threads
+		uint64_t _probes;
+		uint64_t _hits;
 	};
 
 }
@@ -47,7 +47,7 @@ namespace ChessEval {
 
 		static IndexLookupMap getIndexLookup() {
 			IndexLookupMap indexLookup;
-			indexLookup["qMobility"] = std::vector<EvalValue>{ QUEEN_MOBILITY_MAP.begin(), QUEEN_MOBILITY_MAP.end()};
+			indexLookup["qMobility"] = std::vector<EvalValue>(QUEEN_MOBILITY_MAP.begin(), QUEEN_MOBILITY_MAP.end());
 			indexLookup["qProperty"] = std::vector<EvalValue>{ QUEEN_PROPERTY_MAP.begin(), QUEEN_PROPERTY_MAP.end()};
 			indexLookup["qPST"] = PST::getPSTLookup(QUEEN);
 			return indexLookup;
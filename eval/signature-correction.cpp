@@ -0,0 +1,90 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ */
+
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include "signature-correction.h"
+
+using namespace QaplaBasics;
+
+namespace ChessEval {
+
+	bool SignatureCorrection::loadFromFile(const std::string& filename) {
+		std::ifstream in(filename, std::ios::binary);
+		if (!in) {
+			std::cerr << "Failed to open eval correction file: " << filename << std::endl;
+			return false;
+		}
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t count = 0;
+		in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		in.read(reinterpret_cast<char*>(&version), sizeof(version));
+		in.read(reinterpret_cast<char*>(&count), sizeof(count));
+		if (!in || magic != MAGIC || version != VERSION) {
+			std::cerr << "Not an eval correction file: " << filename << std::endl;
+			return false;
+		}
+
+		std::unique_ptr<int16_t[], AlignedDelete> loaded(
+			new (std::align_val_t(CACHE_LINE_SIZE)) int16_t[PieceSignature::SIG_SIZE]());
+		for (uint32_t entry = 0; entry < count; entry++) {
+			uint32_t signature = 0;
+			int16_t correction = 0;
+			in.read(reinterpret_cast<char*>(&signature), sizeof(signature));
+			in.read(reinterpret_cast<char*>(&correction), sizeof(correction));
+			if (!in || signature >= PieceSignature::SIG_SIZE) {
+				std::cerr << "Corrupt eval correction file: " << filename << std::endl;
+				return false;
+			}
+			loaded[signature] = correction;
+		}
+		storage = std::move(loaded);
+		table = storage.get();
+		return true;
+	}
+
+	bool SignatureCorrection::saveToFile(const std::string& filename, const std::vector<int32_t>& corrections) {
+		std::ofstream out(filename, std::ios::binary);
+		if (!out) {
+			std::cerr << "Failed to open file for writing: " << filename << std::endl;
+			return false;
+		}
+		const size_t size = std::min<size_t>(corrections.size(), PieceSignature::SIG_SIZE);
+		const uint32_t count = uint32_t(std::count_if(corrections.begin(), corrections.begin() + size,
+			[](int32_t correction) { return correction != 0; }));
+		out.write(reinterpret_cast<const char*>(&MAGIC), sizeof(MAGIC));
+		out.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+		out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		for (uint32_t signature = 0; signature < size; signature++) {
+			if (corrections[signature] == 0) continue;
+			const int16_t correction = int16_t(std::clamp(corrections[signature], -30000, 30000));
+			out.write(reinterpret_cast<const char*>(&signature), sizeof(signature));
+			out.write(reinterpret_cast<const char*>(&correction), sizeof(correction));
+		}
+		return static_cast<bool>(out);
+	}
+
+	void SignatureCorrection::clear() {
+		table = nullptr;
+		storage.reset();
+	}
+
+}
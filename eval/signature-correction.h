@@ -0,0 +1,78 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Eval correction per piece signature. The corrections are computed by the signature eval 
+ * adjuster and loaded at runtime from a binary file, thus new corrections need no rebuild.
+ * Without a loaded file the correction is zero.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <new>
+#include "../basics/types.h"
+#include "../basics/evalvalue.h"
+#include "../basics/piecesignature.h"
+
+namespace ChessEval {
+
+	class SignatureCorrection {
+	public:
+		/**
+		 * Loads the corrections from a file written by saveToFile
+		 * @returns false, if the file cannot be read. The current corrections are kept then
+		 */
+		static bool loadFromFile(const std::string& filename);
+
+		/**
+		 * Writes the non zero corrections of a table indexed by piece signature
+		 * File format: uint32 magic, uint32 version, uint32 entry count, 
+		 * entries of uint32 signature and int16 correction (from the view of white)
+		 */
+		static bool saveToFile(const std::string& filename, const std::vector<int32_t>& corrections);
+
+		/**
+		 * Removes all corrections
+		 */
+		static void clear();
+
+		/**
+		 * Gets the correction of a piece signature from the view of white, as written by the adjuster.
+		 * The eval adds half of it and only for eval version 1
+		 */
+		static inline QaplaBasics::value_t get(QaplaBasics::pieceSignature_t signature) {
+			return table == nullptr ? 0 : table[signature];
+		}
+
+	private:
+		static constexpr uint32_t MAGIC = 0x43455351; // "QSEC"
+		static constexpr uint32_t VERSION = 1;
+		static constexpr size_t CACHE_LINE_SIZE = 64;
+
+		struct AlignedDelete {
+			void operator()(int16_t* ptr) const { ::operator delete[](ptr, std::align_val_t(CACHE_LINE_SIZE)); }
+		};
+
+		// Dense table of PieceSignature::SIG_SIZE entries or nullptr, if nothing is loaded
+		static inline std::unique_ptr<int16_t[], AlignedDelete> storage;
+		static inline const int16_t* table = nullptr;
+	};
+
+}
@@ -182,6 +182,20 @@ namespace QaplaInterface {
 			return res;
 		}
 
+		/**
+		 * Finds a move given as string in the current position of the board without playing it
+		 */
+		static QaplaBasics::Move findMove(string move, IChessBoard* board) {
+			if (move == "") return QaplaBasics::Move();
+			MoveScanner scanner(move);
+			if (!scanner.isLegal()) return QaplaBasics::Move();
+			return board->findMove(
+				scanner.piece,
+				scanner.departureFile, scanner.departureRank,
+				scanner.destinationFile, scanner.destinationRank,
+				scanner.promote);
+		}
+
 		static bool isCapture(string move, IChessBoard* board) {
 			if (move == "") return false;
 			MoveScanner scanner(move);
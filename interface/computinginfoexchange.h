@@ -39,6 +39,10 @@ namespace QaplaInterface {
 		ComputingInfoExchange() {
 			elapsedTimeInMilliseconds = 0;
 			nodesSearched = 0;
+			pawnHashProbes = 0;
+			pawnHashHits = 0;
+			lazyEvalExits = 0;
+			fullEvals = 0;
 			searchDepth = 1;
 			movesLeftToConcider = 0;
 			totalAmountOfMovesToConcider = 0;
@@ -50,6 +54,10 @@ namespace QaplaInterface {
 
 		uint64_t elapsedTimeInMilliseconds;
 		uint64_t nodesSearched;
+		uint64_t pawnHashProbes;
+		uint64_t pawnHashHits;
+		uint64_t lazyEvalExits;
+		uint64_t fullEvals;
 		uint32_t searchDepth;
 		uint32_t movesLeftToConcider;
 		uint32_t totalAmountOfMovesToConcider;
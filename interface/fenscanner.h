@@ -37,7 +37,13 @@ namespace QaplaInterface {
 			error = true;
 		}
 
-		bool setBoard(string fen, IChessBoard* chessBoard) {
+		/**
+		 * Sets up a board from a fen string
+		 * @param chessBoard an IChessBoard or any other class providing its board setup functions
+		 * @returns false, if the fen is invalid
+		 */
+		template <typename BOARD>
+		bool setBoard(string fen, BOARD* chessBoard) {
 			chessBoard->clearBoard();
 			std::string::iterator fenIterator = fen.begin();
 			error = false;
@@ -76,7 +82,8 @@ namespace QaplaInterface {
 		/**
 		 * Scans the piece sector of a fen string
 		 */
-		void scanPieceSector(const string& fen, string::iterator& fenIterator, IChessBoard* chessBoard) {
+		template <typename BOARD>
+		void scanPieceSector(const string& fen, string::iterator& fenIterator, BOARD* chessBoard) {
 
 			int16_t rank = 0;
 			int16_t file = 7;
@@ -126,7 +133,8 @@ namespace QaplaInterface {
 		/**
 		 * Scans the side to move, either "w" or "b", default white
 		 */
-		void scanSideToMove(const string& fen, string::iterator& fenIterator, IChessBoard* chessBoard) {
+		template <typename BOARD>
+		void scanSideToMove(const string& fen, string::iterator& fenIterator, BOARD* chessBoard) {
 			if (fenIterator != fen.end()) {
 				chessBoard->setWhiteToMove(*fenIterator == 'w');
 				if (*fenIterator != 'w' && *fenIterator != 'b') {
@@ -140,7 +148,8 @@ namespace QaplaInterface {
 		 * Scans the castling rights section 'K', 'Q' for white rights and 'k', 'q' for black rights
 		 * Or '-' for no castling rights
 		 */
-		void scanCastlingRights(const string& fen, string::iterator& fenIterator, IChessBoard* chessBoard) {
+		template <typename BOARD>
+		void scanCastlingRights(const string& fen, string::iterator& fenIterator, BOARD* chessBoard) {
 			bool castlingRightsFound = false;
 
 			// Default: every castle right activated
@@ -186,7 +195,8 @@ namespace QaplaInterface {
 		/**
 		 * Scans an EN-Passant-Field
 		 */
-		void scanEPField(const string& fen, string::iterator& fenIterator, IChessBoard* chessBoard) {
+		template <typename BOARD>
+		void scanEPField(const string& fen, string::iterator& fenIterator, BOARD* chessBoard) {
 			uint32_t epFile = -1;
 			uint32_t epRank = -1;
 			if (fenIterator != fen.end() && *fenIterator == '-') {
@@ -223,11 +233,13 @@ namespace QaplaInterface {
 			return result;
 		}
 
-		void scanHalfMovesWithouthPawnMoveOrCapture(const string& fen, string::iterator& fenIterator, IChessBoard* chessBoard) {
+		template <typename BOARD>
+		void scanHalfMovesWithouthPawnMoveOrCapture(const string& fen, string::iterator& fenIterator, BOARD* chessBoard) {
 			chessBoard->setHalfmovesWithoutPawnMoveOrCapture((uint8_t)scanInteger(fen, fenIterator));
 		}
 
-		void scanPlayedMovesInGame(const string& fen, string::iterator& fenIterator, IChessBoard* chessBoard) {
+		template <typename BOARD>
+		void scanPlayedMovesInGame(const string& fen, string::iterator& fenIterator, BOARD* chessBoard) {
 			chessBoard->setPlayedMovesInGame(scanInteger(fen, fenIterator));
 		}
 
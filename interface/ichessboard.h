@@ -23,11 +23,14 @@
 #pragma once
 
 #include <map>
+#include <string>
+#include <vector>
 #include "clocksetting.h"
 #include "computinginfoexchange.h"
 #include "iwhatIf.h"
 #include "isendsearchinfo.h"
 #include "../eval/eval-exchange-structures.h"
+#include "../basics/move.h"
 
 
 namespace QaplaInterface {
@@ -40,9 +43,27 @@ namespace QaplaInterface {
 		DRAW_BY_NOT_ENOUGHT_MATERIAL,
 		WHITE_WINS_BY_MATE,
 		BLACK_WINS_BY_MATE,
-		ILLEGAL_MOVE
+		ILLEGAL_MOVE,
+		// Self play games ended early by score or bitbase adjudication
+		WHITE_WINS_BY_ADJUDICATION,
+		BLACK_WINS_BY_ADJUDICATION,
+		DRAW_BY_ADJUDICATION
 	};
 
+	inline bool isWhiteWin(GameResult result) {
+		return result == GameResult::WHITE_WINS_BY_MATE || result == GameResult::WHITE_WINS_BY_ADJUDICATION;
+	}
+
+	inline bool isBlackWin(GameResult result) {
+		return result == GameResult::BLACK_WINS_BY_MATE || result == GameResult::BLACK_WINS_BY_ADJUDICATION;
+	}
+
+	inline bool isDraw(GameResult result) {
+		return result == GameResult::DRAW_BY_REPETITION || result == GameResult::DRAW_BY_50_MOVES_RULE
+			|| result == GameResult::DRAW_BY_STALEMATE || result == GameResult::DRAW_BY_NOT_ENOUGHT_MATERIAL
+			|| result == GameResult::DRAW_BY_ADJUDICATION;
+	}
+
     class IChessBoard {
     public:
         virtual ~IChessBoard() = default;
@@ -65,6 +86,24 @@ namespace QaplaInterface {
                             uint32_t destinationFile, uint32_t destinationRank,
                             char promotePiece) = 0;
 
+        /**
+         * Finds the legal move from departure to destination (squares a1 = 0 ... h8 = 63).
+         * Returns an empty move, if there is no such move.
+         */
+        virtual QaplaBasics::Move findMove(uint32_t departure, uint32_t destination, char promotePiece) = 0;
+
+        /** Finds a legal move from partial information, e.g. of a SAN move. Returns an empty move, if it is not unique. */
+        virtual QaplaBasics::Move findMove(char movingPiece,
+                            uint32_t departureFile, uint32_t departureRank,
+                            uint32_t destinationFile, uint32_t destinationRank,
+                            char promotePiece) = 0;
+
+        /** Executes a move of the current position, e.g. one returned by findMove or getComputedMove. Returns false for an illegal move. */
+        virtual bool doMove(QaplaBasics::Move move) = 0;
+
+        /** Returns the best move of the last computeMove or an empty move. */
+        virtual QaplaBasics::Move getComputedMove() = 0;
+
         /** Returns true if the move results in a capture. */
         virtual bool isCapture(char movingPiece,
                                uint32_t departureFile, uint32_t departureRank,
@@ -116,6 +155,10 @@ namespace QaplaInterface {
         /** Executes a perft calculation. */
         virtual uint64_t perft(uint16_t depth, bool verbose = true, uint32_t maxThreadCount = 1) = 0;
 
+        /** Times move generation, eval, SEE and hash on the positions and bitbase probes on the endgames given as FEN. */
+        virtual void microbench(const std::vector<std::string>& fens, const std::vector<std::string>& bitbaseFens, 
+            uint32_t warmup, uint32_t repetitions, uint32_t passes) = 0;
+
         /** Returns the current position in FEN format. */
         virtual std::string getFen() = 0;
 
@@ -125,8 +168,11 @@ namespace QaplaInterface {
         /** Evaluates the current position numerically. */
         virtual value_t eval() = 0;
 
-        /** Computes evaluation index vector for advanced evaluation. */
-        virtual ChessEval::IndexVector computeEvalIndexVector() = 0;
+        /** 
+         * Computes evaluation index vector for advanced evaluation. 
+         * @param allFeatures false: piece signature only, true: every eval feature
+         */
+        virtual ChessEval::IndexVector computeEvalIndexVector(bool allFeatures = false) = 0;
 
         /** Computes evaluation index lookup map for advanced evaluation. */
         virtual ChessEval::IndexLookupMap computeEvalIndexLookupMap() = 0;
@@ -149,12 +195,21 @@ namespace QaplaInterface {
         /** Retrieves the current game result. */
         virtual GameResult getGameResult() = 0;
 
+        /**
+         * Looks the current position up in the loaded bitbases.
+         * Returns an adjudicated win or draw or NOT_ENDED if the position is not in a bitbase.
+         */
+        virtual GameResult getBitbaseResult() { return GameResult::NOT_ENDED; }
+
         /** Returns current computing result information. */
         virtual ComputingInfoExchange getComputingInfo() = 0;
 
         /** Signals that a new game has started. */
         virtual void newGame() {}
 
+        /** Signals that a new game has started, but keeps the hash tables. Entries of former games are aged out. */
+        virtual void newGameKeepHash() { newGame(); }
+
         /** Sets a configuration option (e.g., from GUI). */
         virtual void setOption(std::string name, std::string value) {}
 
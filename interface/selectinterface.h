@@ -54,7 +54,7 @@ namespace QaplaInterface {
 			board->setSendSearchInfo(&sendSearchInfo);
 			uci.run(board, ioHandler);
 		}
-		else if (startsWith(firstToken, { "stat", "epd", "playepd", "wmtest", "train", "material"})) {
+		else if (startsWith(firstToken, { "stat", "epd", "playepd", "wmtest", "bench", "microbench", "selftest", "train", "tune", "convert", "mergeshards", "material"})) {
 			Statistics statistics;
 			statistics.run(board, ioHandler);
 		} 
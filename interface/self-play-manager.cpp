@@ -19,6 +19,13 @@
 
 #include <fstream>
 #include <unordered_map>
+#include <sstream>
+#include <iomanip>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include "self-play-manager.h"
 #include "chessinterface.h"
 #include "../basics/piecesignature.h"
@@ -26,6 +33,103 @@
 
 namespace QaplaInterface {
 
+	void GameRecordWriter::openFile(const std::string& filename, const char* mode) {
+		close();
+		this->filename = filename;
+		if (filename.empty()) return;
+		file = std::fopen(filename.c_str(), mode);
+		if (file == nullptr) {
+			std::cerr << "Failed to open file for writing: " << filename << std::endl;
+			return;
+		}
+		std::setvbuf(file, nullptr, _IOFBF, WRITE_BUFFER_SIZE);
+		startWriterThread();
+	}
+
+	void GameRecordWriter::close() {
+		stopWriterThread();
+		if (file != nullptr) {
+			std::fclose(file);
+			file = nullptr;
+		}
+	}
+
+	void GameRecordWriter::setProducerCount(uint32_t count) {
+		const bool running = writerRunning;
+		stopWriterThread();
+		while (queues.size() < count) {
+			queues.emplace_back(std::make_unique<RecordQueue>());
+		}
+		if (running) startWriterThread();
+	}
+
+	void GameRecordWriter::write(uint32_t producer, const QaplaTraining::GameRecord& game) {
+		if (file == nullptr || producer >= queues.size()) return;
+		std::ostringstream serialized;
+		serialized << game;
+		std::string record = serialized.str();
+		while (!queues[producer]->push(record)) {
+			// Queue full, the writer thread is behind the disk
+			std::this_thread::sleep_for(DRAIN_INTERVAL);
+		}
+	}
+
+	void GameRecordWriter::flush() {
+		if (!writerRunning) return;
+		stopWriterThread();
+		startWriterThread();
+	}
+
+	void GameRecordWriter::startWriterThread() {
+		if (file == nullptr || writerRunning) return;
+		stopRequested = false;
+		writerRunning = true;
+		writerThread = std::thread(&GameRecordWriter::writerLoop, this);
+	}
+
+	void GameRecordWriter::stopWriterThread() {
+		if (!writerRunning) return;
+		stopRequested = true;
+		writerThread.join();
+		writerRunning = false;
+	}
+
+	void GameRecordWriter::writerLoop() {
+		std::string batch;
+		std::string record;
+		auto lastSync = std::chrono::steady_clock::now();
+		while (true) {
+			// Read the flag before draining, so that records queued before a stop request are written
+			const bool stopping = stopRequested;
+			for (auto& queue : queues) {
+				while (queue->pop(record)) {
+					batch += record;
+				}
+			}
+			if (!batch.empty()) {
+				std::fwrite(batch.data(), 1, batch.size(), file);
+				batch.clear();
+			}
+			if (stopping) break;
+			const auto now = std::chrono::steady_clock::now();
+			if (now - lastSync >= SYNC_INTERVAL) {
+				syncFile();
+				lastSync = now;
+			}
+			std::this_thread::sleep_for(DRAIN_INTERVAL);
+		}
+		syncFile();
+	}
+
+	void GameRecordWriter::syncFile() {
+		std::fflush(file);
+#ifdef _WIN32
+		_commit(_fileno(file));
+#else
+		fsync(fileno(file));
+#endif
+	}
+
 	
 	void ResultPerPieceIndex::saveToFile(const std::string& filename) const {
 		std::ofstream out(filename, std::ios::binary);
@@ -103,21 +207,14 @@ namespace QaplaInterface {
 		for (auto index : indexes) {
 			int32_t val = static_cast<int32_t>(index % 8);
 			if (val == 7) continue;
-			switch (gameResult) {
-			case GameResult::WHITE_WINS_BY_MATE:
+			if (isWhiteWin(gameResult)) {
 				signatureWin[index]++;
-				break;
-			case GameResult::BLACK_WINS_BY_MATE:
+			}
+			else if (isBlackWin(gameResult)) {
 				signatureLoss[index]++;
-				break;
-			case GameResult::DRAW_BY_REPETITION:
-			case GameResult::DRAW_BY_STALEMATE:
-			case GameResult::DRAW_BY_50_MOVES_RULE:
-			case GameResult::DRAW_BY_NOT_ENOUGHT_MATERIAL:
+			}
+			else if (isDraw(gameResult)) {
 				signatureDraw[index]++;
-				break;
-			default:
-				break;
 			}
 		}
 	}
@@ -197,10 +294,10 @@ namespace QaplaInterface {
 
 	class GamePairing {
 	public:
-		GamePairing(const IChessBoard* boardTemplate, const ClockSetting& clock, int32_t random)
+		GamePairing(const IChessBoard* boardTemplate, const ClockSetting& clock, int32_t random, uint32_t hashSizeInMegabytes)
 			: curBoard(boardTemplate->createNew()), newBoard(boardTemplate->createNew()), clock(clock) {
-			curBoard->setOption("Hash", "2");
-			newBoard->setOption("Hash", "2");
+			curBoard->setOption("Hash", std::to_string(hashSizeInMegabytes));
+			newBoard->setOption("Hash", std::to_string(hashSizeInMegabytes));
 			curBoard->setEvalVersion(0);
 			newBoard->setEvalVersion(1);
 			curBoard->setClock(clock);
@@ -223,40 +320,71 @@ namespace QaplaInterface {
 		auto eval() const {
 			return curBoard->eval();
 		}
-		void newGame() const {
-			curBoard->newGame();
-			newBoard->newGame();
+		void newGame(bool keepHash) const {
+			if (keepHash) {
+				curBoard->newGameKeepHash();
+				newBoard->newGameKeepHash();
+			}
+			else {
+				curBoard->newGame();
+				newBoard->newGame();
+			}
+		}
+		/**
+		 * Seeds the random eval bonus and the node variation of a game
+		 */
+		void setGameSeed(uint64_t seed) {
+			gameSeed = seed;
+			curBoard->setEvalFeature("randomseed", value_t(seed));
+			newBoard->setEvalFeature("randomseed", value_t(seed));
+		}
+		/**
+		 * Varies the node target of every move by up to percent percent
+		 */
+		void setNodeVariation(uint32_t percent) {
+			nodeVariation = percent;
 		}
 		IChessBoard* getCurBoard() const {
 			return curBoard;
 		}
-		bool isCapture(std::string move) const {
-			return ChessInterface::isCapture(move, curBoard);
-		}
-		std::tuple<GameResult, std::string, value_t, bool> computeMove(bool curIsWhite) const {
-			const auto ADJUDICATE = false;
+		std::tuple<GameResult, Move, value_t, bool> computeMove(bool curIsWhite, uint32_t ply) const {
 			ComputingInfoExchange computingInfo;
 			IChessBoard* sideToPlay = curIsWhite == curBoard->isWhiteToMove() ? curBoard : newBoard;
+			// The clock is set on every move, as a search stopped by a limit leaves the clock stopped
+			sideToPlay->setClock(computeMoveClock(ply));
 			sideToPlay->computeMove();
 			computingInfo = sideToPlay->getComputingInfo();
 			const auto value = computingInfo.valueInCentiPawn;
-			const auto move = computingInfo.currentConsideredMove;
-			GameResult result;
-			bool capture = isCapture(move);
-			if (ADJUDICATE && abs(value) > 1000) {
-				result = value > 1000 == sideToPlay->isWhiteToMove() ? GameResult::WHITE_WINS_BY_MATE : GameResult::BLACK_WINS_BY_MATE;
-			}
-			else {
-				bool illegalMove = !ChessInterface::setMove(move, curBoard);
-				ChessInterface::setMove(move, newBoard);
-				result = illegalMove ? GameResult::ILLEGAL_MOVE : curBoard->getGameResult();
-			}
+			const Move move = sideToPlay->getComputedMove();
+			bool capture = move.isCapture();
+			bool illegalMove = !curBoard->doMove(move);
+			newBoard->doMove(move);
+			GameResult result = illegalMove ? GameResult::ILLEGAL_MOVE : curBoard->getGameResult();
 			return std::tuple(result, move, value, capture);
 		}
 		IChessBoard* curBoard;
 		IChessBoard* newBoard;
 		ClockSetting clock;
 	private:
+		/**
+		 * Draws the node target of a move from [target - variation, target + variation] 
+		 * reproducible from the game seed and the ply
+		 */
+		ClockSetting computeMoveClock(uint32_t ply) const {
+			ClockSetting moveClock = clock;
+			const uint64_t target = clock.getNodeTarget();
+			if (target == 0 || nodeVariation == 0) {
+				return moveClock;
+			}
+			const uint64_t variation = target * nodeVariation / 100;
+			uint64_t random = (gameSeed << 10) + ply;
+			random = (random ^ (random >> 33)) * 0xFF51AFD7ED558CCDULL;
+			random ^= random >> 29;
+			moveClock.setNodeCount(target - variation + random % (2 * variation + 1));
+			return moveClock;
+		}
+		uint64_t gameSeed = 0;
+		uint32_t nodeVariation = 0;
 		GamePairing(const GamePairing&) = delete;
 	};
 
@@ -266,57 +394,93 @@ namespace QaplaInterface {
 		, uint32_t games
 		, uint64_t gamesPerEpd) {
 		stop();
+		writer.setProducerCount(numThreads);
+		threadCount = numThreads;
 		timeControl.storeStartTime();
 		this->startPositions = startPositions;
 		gameStatistics.clear();
+		adjudicationCount.fill(0);
+		sprt.clear();
+		pendingPairs.clear();
 		computer1Result = 0;
 		gamesPlayed = 0;
 		fiftyMovesRule = 0;
 		epdIndex = 0;
+		batchEnd = 0;
+		runningWorkers = numThreads;
+		const uint64_t positionGames = statistic ? startPositions.size() * gamesPerEpd : startPositions.size();
+		const uint64_t totalGames = games > 0 ? std::min<uint64_t>(games, positionGames) : positionGames;
 
 		for (size_t i = 0; i < numThreads; ++i) {
 			if (i >= workers.size()) {
 				workers.emplace_back(std::make_unique<WorkerThread>());
 			}
-			auto task = std::function<void()>([this, gamesPerEpd, i, boardTemplate, clock, games]() {
-				srand(static_cast<unsigned>(time(nullptr)) ^ static_cast<unsigned>(i));
-				GamePairing gamePairing = GamePairing(boardTemplate, clock, gamesPerEpd == 1 ? 0 : 10);
+			auto task = std::function<void()>([this, gamesPerEpd, i, boardTemplate, clock, games, totalGames]() {
+				GamePairing gamePairing = GamePairing(boardTemplate, clock, gamesPerEpd == 1 ? 0 : 10, hashSizeInMegabytes);
+				gamePairing.setNodeVariation(nodeVariation);
 				std::string last;
 				while (!stopped) {
 					bool curIsWhite; // This is the default version not the version with changed evaluation
 					uint64_t epdNo = 0;
+					uint64_t gameNo = 0;
 					std::string fen = "";
 					{
 						std::lock_guard<std::mutex> lock(positionMutex);
+						if (queue.isOpen() && epdIndex >= batchEnd && !queue.claimBatch(totalGames, epdIndex, batchEnd)) {
+							break;
+						}
 						epdNo = statistic ? epdIndex / gamesPerEpd : epdIndex;
 						if (epdNo >= this->startPositions.size() || (games > 0 && epdIndex >= games)) {
 							break;
 						}
 						curIsWhite = (epdIndex % gamesPerEpd) == 0;
 						fen = this->startPositions[epdNo];
+						gameNo = epdIndex;
 						epdIndex++;
 					}
-					auto [game, gameStr] = playSingleGame(gamePairing, fen, static_cast<uint32_t>(epdNo), curIsWhite);
+					gamePairing.setGameSeed(seed + gameNo);
+					auto [game, gameStr, adjudication] = playSingleGame(gamePairing, fen, static_cast<uint32_t>(epdNo), curIsWhite);
+					writer.write(static_cast<uint32_t>(i), game);
 					{
 						std::lock_guard<std::mutex> lock(statsMutex);
 						const auto result = game.getResult();
 						gameStatistics[result]++;
+						adjudicationCount[size_t(adjudication)]++;
 						int32_t curResult = 0;
-						if (result == GameResult::WHITE_WINS_BY_MATE) {
+						if (isWhiteWin(result)) {
 							curResult = curIsWhite ? 1 : -1;
 						}
-						else if (result == GameResult::BLACK_WINS_BY_MATE) {
+						else if (isBlackWin(result)) {
 							curResult = curIsWhite ? -1 : +1;
 						}
 						else if (result == GameResult::DRAW_BY_REPETITION) fiftyMovesRule++;
-						writer.write(game);
-						/*
-						CandidateTrainer::setGameResult(curResult == -1, curResult == 0);
-						auto confidence = CandidateTrainer::getConfidenceInterval();
-						if (CandidateTrainer::shallTerminate()) break;
-						*/
+						if (candidateTraining) {
+							CandidateTrainer::setGameResult(curResult == -1, curResult == 0);
+							if (!sprtEnabled && CandidateTrainer::shallTerminate()) stopped = true;
+						}
 						computer1Result += curResult;
 						gamesPlayed++;
+						if (result != GameResult::NOT_ENDED) {
+							queue.gameFinished(gameNo);
+						}
+						if (sprtEnabled && result != GameResult::NOT_ENDED) {
+							// curResult is from the view of the default evaluation
+							const uint32_t halfPoints = static_cast<uint32_t>(1 - curResult);
+							// The pair partner is a game of the same start position with swapped colors
+							auto& partners = pendingPairs[epdNo * 2 + (curIsWhite ? 0 : 1)];
+							if (partners.empty()) {
+								pendingPairs[epdNo * 2 + (curIsWhite ? 1 : 0)].push_back(halfPoints);
+							}
+							else {
+								sprt.addPair(partners.back() + halfPoints);
+								partners.pop_back();
+								if (!stopped && sprt.getStatus() != Sprt::Status::CONTINUE) {
+									stopped = true;
+									std::cout << std::endl;
+									printStatistics();
+								}
+							}
+						}
 						const auto positions = statistic ? this->startPositions.size() * gamesPerEpd : this->startPositions.size();
 						double timeSpentInSeconds = double(timeControl.getTimeSpentInMilliseconds()) / 1000.0;
 						double estimatedTotalTime = timeSpentInSeconds * double(positions) / double(gamesPlayed);
@@ -329,6 +493,21 @@ namespace QaplaInterface {
 								;
 							if (gamesPlayed == games) std::cout << std::endl;
 						}
+						if (!queue.isOpen() && (gamesPlayed == games || gamesPlayed == positions)) {
+							printStatistics();
+						}
+					}
+				}
+				// With a queue this process plays a part of the games only, thus the last worker reports
+				if (--runningWorkers == 0 && queue.isOpen() && !stopped) {
+					std::lock_guard<std::mutex> lock(statsMutex);
+					if (queue.getClaimedBatches() == 0) {
+						std::cerr << "Error: every batch of the queue " << queue.getDirectory() 
+							<< " is already claimed, reset it with \"mergeshards <file> queue <directory>\"" << std::endl;
+					}
+					else {
+						std::cout << std::endl;
+						printStatistics();
 					}
 				}
 			});
@@ -336,29 +515,96 @@ namespace QaplaInterface {
 		}
 	}
 
-	std::pair<QaplaTraining::GameRecord, std::string>
+	std::pair<GameResult, SelfPlayManager::Adjudication> SelfPlayManager::adjudicate(const GamePairing& gamePairing,
+		value_t whiteValue, uint32_t moveNumber, AdjudicationPlies& plies) const {
+		const auto& settings = adjudicationSettings;
+		if (settings.bitbase) {
+			const GameResult result = gamePairing.getCurBoard()->getBitbaseResult();
+			if (result != GameResult::NOT_ENDED) {
+				return { result, Adjudication::BITBASE };
+			}
+		}
+		plies.whiteWins = whiteValue >= settings.winScore ? plies.whiteWins + 1 : 0;
+		plies.blackWins = -whiteValue >= settings.winScore ? plies.blackWins + 1 : 0;
+		plies.draw = moveNumber >= settings.drawMove && abs(whiteValue) <= settings.drawScore ? plies.draw + 1 : 0;
+		if (settings.winScore > 0 && settings.winPlies > 0) {
+			if (plies.whiteWins >= settings.winPlies) return { GameResult::WHITE_WINS_BY_ADJUDICATION, Adjudication::WIN };
+			if (plies.blackWins >= settings.winPlies) return { GameResult::BLACK_WINS_BY_ADJUDICATION, Adjudication::WIN };
+		}
+		if (settings.drawMove > 0 && settings.drawPlies > 0 && plies.draw >= settings.drawPlies) {
+			return { GameResult::DRAW_BY_ADJUDICATION, Adjudication::DRAW };
+		}
+		return { GameResult::NOT_ENDED, Adjudication::NONE };
+	}
+
+	void SelfPlayManager::printStatistics() const {
+		uint64_t whiteWins = 0;
+		uint64_t blackWins = 0;
+		uint64_t draws = 0;
+		for (const auto& [result, count] : gameStatistics) {
+			if (isWhiteWin(result)) whiteWins += count;
+			else if (isBlackWin(result)) blackWins += count;
+			else if (result != GameResult::NOT_ENDED && result != GameResult::ILLEGAL_MOVE) draws += count;
+		}
+		std::cout << "Games: " << gamesPlayed
+			<< " white wins: " << whiteWins << " black wins: " << blackWins << " draws: " << draws << std::endl;
+		std::cout << "Adjudicated win: " << adjudicationCount[size_t(Adjudication::WIN)]
+			<< " draw: " << adjudicationCount[size_t(Adjudication::DRAW)]
+			<< " bitbase: " << adjudicationCount[size_t(Adjudication::BITBASE)] << std::endl;
+		const double hours = double(timeControl.getTimeSpentInMilliseconds()) / 3600000.0;
+		if (hours > 0) {
+			std::cout << "Games per hour and core: " << std::fixed << std::setprecision(0)
+				<< double(gamesPlayed) / hours / double(threadCount) << std::defaultfloat
+				<< " (hash " << hashSizeInMegabytes << " MB" << (warmEngines ? ", warm engines)" : ")") << std::endl;
+		}
+		if (sprtEnabled) {
+			sprt.print(std::cout);
+		}
+	}
+
+	std::tuple<QaplaTraining::GameRecord, std::string, SelfPlayManager::Adjudication>
 		SelfPlayManager::playSingleGame(const GamePairing& gamePairing, std::string fen, uint32_t fenIndex, bool curIsWhite) const {
 
-		std::string gameResultString = fen;
+		std::string gameResultString;
+		std::vector<std::pair<Move, value_t>> playedMoves;
 		QaplaTraining::GameRecord gameRecord;
 		gameRecord.setFENId(fenIndex);
 
-		gamePairing.newGame();
+		gamePairing.newGame(warmEngines);
 		gamePairing.setPositionByFen(fen);
 		GameResult gameResult = gamePairing.getGameResult();
 		bool captureBefore = false;
-		auto moveNo = 2;
+		uint32_t moveNo = 2;
+		AdjudicationPlies plies;
+		Adjudication adjudication = Adjudication::NONE;
 		while (gameResult == GameResult::NOT_ENDED && !stopped) {
-			const auto [result, move, value, capture] = gamePairing.computeMove(curIsWhite);
-			gameResultString += ", " + (moveNo % 2 == 0 ? to_string(moveNo / 2) + ". " : "") + move + ", " + std::to_string(value);
+			const bool whiteToMove = gamePairing.getCurBoard()->isWhiteToMove();
+			const auto [result, move, value, capture] = gamePairing.computeMove(curIsWhite, moveNo - 2);
+			if (!quiet) {
+				playedMoves.emplace_back(move, value);
+			}
 			gameRecord.addMove(move, value);
 			gameResult = result;
 			moveNo++;
+			if (gameResult == GameResult::NOT_ENDED) {
+				std::tie(gameResult, adjudication) = adjudicate(gamePairing, whiteToMove ? value : -value, moveNo / 2, plies);
+			}
 		}
 		if (!stopped) {
 			gameRecord.setResult(gameResult);
-			std::cout << gameResultString << std::endl;
+			if (!quiet) {
+				// The move list is formatted once per game, not on every move
+				std::ostringstream out;
+				out << fen;
+				for (size_t ply = 0; ply < playedMoves.size(); ply++) {
+					out << ", ";
+					if (ply % 2 == 0) out << (ply / 2 + 1) << ". ";
+					out << playedMoves[ply].first.getLAN() << ", " << playedMoves[ply].second;
+				}
+				gameResultString = out.str();
+				std::cout << gameResultString << std::endl;
+			}
 		}
-		return { gameRecord, gameResultString };
+		return { gameRecord, gameResultString, adjudication };
 	}
 }
\ No newline at end of file
@@ -24,8 +24,17 @@
 //#include "EPDTest.h"
 #include <fstream>
 #include <vector>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <unordered_map>
 #include "chessinterface.h"
 #include "candidate-trainer.h"
+#include "sprt.h"
+#include "self-play-queue.h"
 #include "../search/boardadapter.h"
 #include "../training/game-record.h"
 
@@ -38,7 +47,9 @@ namespace QaplaInterface {
 
 	/**
 	 * Handles writing GameRecord objects to a binary file.
-	 * Automatically opens and closes the file. Flushes after each write.
+	 * Every self play thread owns a lock free single producer queue of serialized records.
+	 * A dedicated writer thread drains the queues, writes the records in batches and
+	 * syncs the file to disk periodically, thus the players never wait for the disk.
 	 */
 	class GameRecordWriter {
 	public:
@@ -50,16 +61,7 @@ namespace QaplaInterface {
 		 * @param filename Path to the output file
 		 */
 		void open(const std::string& filename) {
-			this->filename = filename;
-			if (out.is_open()) {
-				out.close();
-			}
-			if (!filename.empty()) {
-				out.open(filename, std::ios::binary | std::ios::out | std::ios::trunc);
-				if (!out) {
-					std::cerr << "Failed to open file for writing: " << filename << std::endl;
-				}
-			}
+			openFile(filename, "wb");
 		}
 
 		/**
@@ -68,46 +70,87 @@ namespace QaplaInterface {
 		 * @param filename Path to the output file
 		 */
 		void append(const std::string& filename) {
-			this->filename = filename;
-			if (out.is_open()) {
-				out.close();
-			}
-			if (!filename.empty()) {
-				out.open(filename, std::ios::binary | std::ios::out | std::ios::app);
-				if (!out) {
-					std::cerr << "Failed to open file for appending: " << filename << std::endl;
-				}
-			}
+			openFile(filename, "ab");
 		}
 
-		void close() {
-			if (out.is_open()) {
-				out.close();
-			}
-		}
+		/**
+		 * Writes all pending records, syncs and closes the file
+		 */
+		void close();
 
 		~GameRecordWriter() {
 			close();
 		}
 
 		/**
-		 * Writes a GameRecord to the file. Does nothing if file is not open.
+		 * Provides one queue per producer. Must not be called while a producer writes.
 		 *
+		 * @param count Number of producer threads
+		 */
+		void setProducerCount(uint32_t count);
+
+		/**
+		 * Queues a GameRecord for writing. Does nothing if file is not open.
+		 * Lock free, but every producer must use its own producer number.
+		 *
+		 * @param producer Number of the calling thread in [0, producer count)
 		 * @param game GameRecord to write
 		 */
-		void write(const QaplaTraining::GameRecord& game) {
-			if (!out.is_open()) return;
-			out << game;
-			out.flush();
-		}
+		void write(uint32_t producer, const QaplaTraining::GameRecord& game);
+
+		/**
+		 * Blocks until all records queued so far are written and synced to disk
+		 */
+		void flush();
 
 		std::string getFilename() const {
 			return filename;
 		}
 
 	private:
-		std::ofstream out;
+		/**
+		 * Bounded single producer, single consumer ring buffer
+		 */
+		class RecordQueue {
+		public:
+			bool push(std::string& record) {
+				const uint32_t head = headIndex.load(std::memory_order_relaxed);
+				const uint32_t next = (head + 1) % CAPACITY;
+				if (next == tailIndex.load(std::memory_order_acquire)) return false;
+				slots[head].swap(record);
+				headIndex.store(next, std::memory_order_release);
+				return true;
+			}
+			bool pop(std::string& record) {
+				const uint32_t tail = tailIndex.load(std::memory_order_relaxed);
+				if (tail == headIndex.load(std::memory_order_acquire)) return false;
+				record.swap(slots[tail]);
+				tailIndex.store((tail + 1) % CAPACITY, std::memory_order_release);
+				return true;
+			}
+		private:
+			static constexpr uint32_t CAPACITY = 256;
+			std::array<std::string, CAPACITY> slots;
+			alignas(64) std::atomic<uint32_t> headIndex{ 0 };
+			alignas(64) std::atomic<uint32_t> tailIndex{ 0 };
+		};
+
+		void openFile(const std::string& filename, const char* mode);
+		void startWriterThread();
+		void stopWriterThread();
+		void writerLoop();
+		void syncFile();
+
+		static constexpr std::chrono::milliseconds DRAIN_INTERVAL{ 20 };
+		static constexpr std::chrono::seconds SYNC_INTERVAL{ 5 };
+		static constexpr size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+		std::FILE* file = nullptr;
 		std::string filename;
+		std::vector<std::unique_ptr<RecordQueue>> queues;
+		std::thread writerThread;
+		std::atomic<bool> writerRunning{ false };
+		std::atomic<bool> stopRequested{ false };
 	};
 
 
@@ -150,14 +193,103 @@ namespace QaplaInterface {
 		
 	};
 
+	/**
+	 * Rules to end self play games early. A rule is disabled by a zero score, move or ply value.
+	 */
+	struct AdjudicationSettings {
+		// Win, if both engines report at least winScore for the same side for winPlies consecutive plies
+		value_t winScore = 0;
+		uint32_t winPlies = 4;
+		// Draw, if from move drawMove on both engines report at most drawScore for drawPlies consecutive plies
+		uint32_t drawMove = 0;
+		value_t drawScore = 10;
+		uint32_t drawPlies = 8;
+		// Ends the game with the bitbase result, if the position is in a loaded bitbase
+		bool bitbase = false;
+	};
+
 	class SelfPlayManager {
 	private:
 		
 	public:
 		SelfPlayManager() : epdIndex(0) {}
 
+		/**
+		 * Sets the record file. With a queue, the records are written to the shard file of this process.
+		 */
 		void setOutputFile(const std::string& filename) {
-			writer.append(filename);
+			writer.append(queue.isOpen() ? queue.getShardFilename(filename) : filename);
+		}
+
+		/**
+		 * Claims the games in batches from a queue directory shared with other processes instead
+		 * of playing all games. Call before setOutputFile. An empty directory disables the queue.
+		 * @param batchSize Games per batch, a multiple of the games per start position
+		 * @param staleSeconds Time without a finished game, after which a claim of another process is taken back
+		 */
+		bool setQueue(const std::string& directory, uint64_t batchSize, 
+			uint32_t staleSeconds = SelfPlayQueue::DEFAULT_STALE_SECONDS) {
+			queue.close();
+			return directory.empty() || queue.open(directory, batchSize, staleSeconds);
+		}
+
+		/**
+		 * Suppresses printing every finished game to stdout
+		 */
+		void setQuiet(bool quiet) {
+			this->quiet = quiet;
+		}
+
+		void setAdjudication(const AdjudicationSettings& settings) {
+			adjudicationSettings = settings;
+		}
+
+		/**
+		 * Stops the match, once a sprt of the changed evaluation against the default evaluation
+		 * crossed a bound. Two games of the same start position, one with each color for the
+		 * changed evaluation, form a pair. Needs at least two games per start position.
+		 */
+		void setSprt(bool enabled, const Sprt::Settings& settings = Sprt::Settings()) {
+			sprtEnabled = enabled;
+			sprt.setSettings(settings);
+		}
+
+		/**
+		 * Varies the node target of every move by up to percent percent. Used with a node target clock.
+		 */
+		void setNodeVariation(uint32_t percent) {
+			nodeVariation = percent;
+		}
+
+		/**
+		 * Sets the seed of the random eval bonus and node variation. Game n uses seed + n, thus
+		 * games at a node target are reproducible independent of the thread count.
+		 */
+		void setSeed(uint64_t seed) {
+			this->seed = seed;
+		}
+
+		/**
+		 * Sets the hash size of every engine in megabytes
+		 */
+		void setHashSize(uint32_t megabytes) {
+			hashSizeInMegabytes = megabytes;
+		}
+
+		/**
+		 * Keeps the hash of the engines of a worker between its games and only ages the entries
+		 * instead of clearing them. Games then depend on the games the worker played before, thus
+		 * node target games are no longer reproducible independent of the thread count.
+		 */
+		void setWarmEngines(bool warm) {
+			warmEngines = warm;
+		}
+
+		/**
+		 * Reports the game results to the current candidate of the CandidateTrainer
+		 */
+		void setCandidateTraining(bool enabled) {
+			candidateTraining = enabled;
 		}
 
 		void start(uint32_t numThreads, const ClockSetting& clock
@@ -176,13 +308,37 @@ namespace QaplaInterface {
 			for (auto& worker : workers) {
 				worker->waitForTaskCompletion();
 			}
+			writer.flush();
 		}
 
 	private:
+		enum class Adjudication {
+			NONE, WIN, DRAW, BITBASE, COUNT
+		};
+
+		/**
+		 * Consecutive plies fulfilling the adjudication rules
+		 */
+		struct AdjudicationPlies {
+			uint32_t whiteWins = 0;
+			uint32_t blackWins = 0;
+			uint32_t draw = 0;
+		};
 
-		std::pair<QaplaTraining::GameRecord, std::string> 
+		std::tuple<QaplaTraining::GameRecord, std::string, Adjudication>
 			playSingleGame(const GamePairing& gamePairing, std::string fen, uint32_t fenIndex, bool curIsWhite) const;
 
+		/**
+		 * Checks the adjudication rules after a move
+		 * @param whiteValue Search value of the move from the view of white
+		 * @param moveNumber Full move number of the game
+		 * @returns the adjudicated game result or NOT_ENDED
+		 */
+		std::pair<GameResult, Adjudication> adjudicate(const GamePairing& gamePairing, value_t whiteValue,
+			uint32_t moveNumber, AdjudicationPlies& plies) const;
+
+		void printStatistics() const;
+
 		uint64_t computer1Result;
 		uint64_t gamesPlayed;
 		uint64_t fiftyMovesRule = 0;
@@ -190,13 +346,30 @@ namespace QaplaInterface {
 		std::vector<std::unique_ptr<WorkerThread>> workers;
 		std::array<int32_t, 1024> gameResults;
 		std::map<GameResult, uint32_t> gameStatistics;
+		std::array<uint64_t, size_t(Adjudication::COUNT)> adjudicationCount;
 		std::mutex statsMutex;
 		std::mutex positionMutex;
 		uint64_t epdIndex;
-		bool stopped;
+		// Index behind the last game of the batch claimed from the queue
+		uint64_t batchEnd = 0;
+		std::atomic<uint32_t> runningWorkers{ 0 };
+		std::atomic<bool> stopped{ false };
 		bool statistic = true;
+		bool quiet = false;
+		AdjudicationSettings adjudicationSettings;
+		bool sprtEnabled = false;
+		bool candidateTraining = false;
+		uint32_t nodeVariation = 0;
+		uint64_t seed = 0;
+		uint32_t hashSizeInMegabytes = 2;
+		bool warmEngines = false;
+		uint32_t threadCount = 1;
+		Sprt sprt;
+		SelfPlayQueue queue;
+		// Half points of the changed evaluation in games still waiting for the game with the other color,
+		// indexed by start position number * 2 + (1, if the default evaluation played white)
+		std::unordered_map<uint64_t, std::vector<uint32_t>> pendingPairs;
 		StdTimeControl timeControl;
-		ResultPerPieceIndex resultPerPieceIndex;
 		GameRecordWriter writer;
 	};
 
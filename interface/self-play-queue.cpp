@@ -0,0 +1,197 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Distributes self play games to several processes sharing a queue directory
+ */
+
+#include <cstdio>
+#include <ctime>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include "self-play-queue.h"
+#include "../training/game-record.h"
+
+namespace QaplaInterface {
+
+	bool SelfPlayQueue::open(const std::string& directoryName, uint64_t batchSize, uint32_t staleSeconds) {
+		close();
+		std::error_code error;
+		std::filesystem::create_directories(directoryName, error);
+		if (!std::filesystem::is_directory(directoryName)) {
+			std::cerr << "Failed to create queue directory: " << directoryName << std::endl;
+			return false;
+		}
+		directory = directoryName;
+		this->batchSize = std::max<uint64_t>(1, batchSize);
+		this->staleSeconds = staleSeconds;
+		nextBatch = 0;
+		for (shard = 0; !createExclusive(directory / ("shard-" + std::to_string(shard) + ".lock")); shard++) {
+			if (shard >= 100000) {
+				std::cerr << "Failed to claim a shard in queue directory: " << directoryName << std::endl;
+				close();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool SelfPlayQueue::claimBatch(uint64_t totalGames, uint64_t& begin, uint64_t& end) {
+		if (!isOpen()) return false;
+		for (; nextBatch * batchSize < totalGames; nextBatch++) {
+			if (createExclusive(getBatchPath(nextBatch, LOCK_EXTENSION))) {
+				addClaim(nextBatch, totalGames, begin, end);
+				nextBatch++;
+				return true;
+			}
+		}
+		// All batches are claimed, take back the ones of crashed processes
+		for (uint64_t batchNo = 0; staleSeconds > 0 && batchNo * batchSize < totalGames; batchNo++) {
+			if (reclaimStale(batchNo)) {
+				std::cout << "Took back the stale claim of batch " << batchNo << std::endl;
+				addClaim(batchNo, totalGames, begin, end);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void SelfPlayQueue::addClaim(uint64_t batchNo, uint64_t totalGames, uint64_t& begin, uint64_t& end) {
+		begin = batchNo * batchSize;
+		end = std::min(begin + batchSize, totalGames);
+		std::lock_guard<std::mutex> lock(mtx);
+		openGames[batchNo] = end - begin;
+		claimedBatches++;
+	}
+
+	void SelfPlayQueue::gameFinished(uint64_t gameNo) {
+		if (!isOpen()) return;
+		const uint64_t batchNo = gameNo / batchSize;
+		std::error_code error;
+		std::filesystem::last_write_time(getBatchPath(batchNo, LOCK_EXTENSION), 
+			std::filesystem::file_time_type::clock::now(), error);
+		std::lock_guard<std::mutex> lock(mtx);
+		const auto it = openGames.find(batchNo);
+		if (it == openGames.end() || --it->second > 0) return;
+		openGames.erase(it);
+		createExclusive(getBatchPath(batchNo, DONE_EXTENSION));
+	}
+
+	bool SelfPlayQueue::isStale(const std::filesystem::path& path) const {
+		std::error_code error;
+		const auto modified = std::filesystem::last_write_time(path, error);
+		return !error && std::filesystem::file_time_type::clock::now() - modified > std::chrono::seconds(staleSeconds);
+	}
+
+	bool SelfPlayQueue::reclaimStale(uint64_t batchNo) {
+		const auto lockPath = getBatchPath(batchNo, LOCK_EXTENSION);
+		if (std::filesystem::exists(getBatchPath(batchNo, DONE_EXTENSION)) || !isStale(lockPath)) {
+			return false;
+		}
+		// Renaming is atomic, thus only one process moves the stale lock file away
+		auto stalePath = lockPath;
+		stalePath += ".stale" + std::to_string(shard);
+		std::error_code error;
+		std::filesystem::rename(lockPath, stalePath, error);
+		if (error) return false;
+		if (!isStale(stalePath)) {
+			// Another process took back the claim in the meantime, give it back
+			std::filesystem::rename(stalePath, lockPath, error);
+			return false;
+		}
+		std::filesystem::remove(stalePath, error);
+		return createExclusive(lockPath);
+	}
+
+	bool SelfPlayQueue::createExclusive(const std::filesystem::path& path) const {
+		// "x" fails, if the file exists; the file system performs check and creation atomically
+		std::FILE* file = std::fopen(path.string().c_str(), "wx");
+		if (file == nullptr) {
+			return false;
+		}
+		std::fprintf(file, "shard %u time %lld\n", shard, static_cast<long long>(std::time(nullptr)));
+		std::fclose(file);
+		return true;
+	}
+
+	uint64_t SelfPlayQueue::reset(const std::string& directoryName) {
+		std::error_code error;
+		std::vector<std::filesystem::path> files;
+		uint64_t claims = 0;
+		uint64_t doneBatches = 0;
+		for (const auto& entry : std::filesystem::directory_iterator(directoryName, error)) {
+			const std::string name = entry.path().filename().string();
+			const bool isBatch = name.compare(0, 6, "batch-") == 0;
+			const bool isShard = name.compare(0, 6, "shard-") == 0;
+			if (!isBatch && !isShard) continue;
+			if (isBatch && entry.path().extension() == LOCK_EXTENSION) claims++;
+			else if (isBatch && entry.path().extension() == DONE_EXTENSION) doneBatches++;
+			files.push_back(entry.path());
+		}
+		for (const auto& path : files) {
+			std::filesystem::remove(path, error);
+		}
+		return claims - std::min(claims, doneBatches);
+	}
+
+	uint64_t SelfPlayQueue::mergeShards(const std::string& filename) {
+		const std::filesystem::path target(filename);
+		const std::filesystem::path folder = target.has_parent_path() ? target.parent_path() : std::filesystem::path(".");
+		const std::string prefix = target.filename().string() + SHARD_SUFFIX;
+		std::vector<std::pair<uint32_t, std::filesystem::path>> shards;
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(folder, error)) {
+			const std::string name = entry.path().filename().string();
+			if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0
+				&& std::all_of(name.begin() + prefix.size(), name.end(), [](char ch) { return ch >= '0' && ch <= '9'; })) {
+				shards.emplace_back(uint32_t(std::stoul(name.substr(prefix.size()))), entry.path());
+			}
+		}
+		std::sort(shards.begin(), shards.end());
+
+		std::ofstream out(filename, std::ios::binary | std::ios::app);
+		if (!out) {
+			std::cerr << "Failed to open file for writing: " << filename << std::endl;
+			return 0;
+		}
+		uint64_t total = 0;
+		for (const auto& [shardNo, path] : shards) {
+			uint64_t games = 0;
+			{
+				QaplaTraining::GameRecordReader reader(path.string());
+				QaplaTraining::GameRecord game;
+				while (reader.read(game)) {
+					out << game;
+					games++;
+				}
+			}
+			out.flush();
+			if (!out) {
+				std::cerr << "Failed to write " << filename << ", keeping " << path.string() << std::endl;
+				break;
+			}
+			std::filesystem::remove(path, error);
+			std::cout << "Merged " << games << " games from " << path.string() << std::endl;
+			total += games;
+		}
+		return total;
+	}
+
+}
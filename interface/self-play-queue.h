@@ -0,0 +1,150 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Distributes self play games to several processes sharing a queue directory, e.g. on a
+ * network file system. A process claims a shard number and batches of games by creating
+ * lock files exclusively; the file system decides, which process gets a lock file. Every
+ * process writes its games to its own shard file; the shards are merged afterwards.
+ * A lock file holds the owning shard and the claim time. The owner refreshes its modification
+ * time with every finished game and writes a done file after the last game of a batch, thus
+ * a claim not refreshed for a while belongs to a crashed process and is taken back.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
+
+namespace QaplaInterface {
+
+	class SelfPlayQueue {
+	public:
+		static constexpr uint32_t DEFAULT_STALE_SECONDS = 3600;
+
+		/**
+		 * Opens (and creates) the queue directory and claims a shard number
+		 * @param batchSize Number of games claimed at once
+		 * @param staleSeconds Time without a finished game, after which a claim of another process
+		 *                     is taken back, 0 to never take back claims
+		 * @returns false, if the directory cannot be used
+		 */
+		bool open(const std::string& directory, uint64_t batchSize, uint32_t staleSeconds = DEFAULT_STALE_SECONDS);
+
+		void close() {
+			directory.clear();
+			std::lock_guard<std::mutex> lock(mtx);
+			openGames.clear();
+			claimedBatches = 0;
+		}
+
+		bool isOpen() const {
+			return !directory.empty();
+		}
+
+		/**
+		 * Gets the name of the record file of this process
+		 */
+		std::string getShardFilename(const std::string& filename) const {
+			return filename + SHARD_SUFFIX + std::to_string(shard);
+		}
+
+		std::string getDirectory() const {
+			return directory.string();
+		}
+
+		/**
+		 * Claims the next batch of games not claimed by any process. If there is none, it takes
+		 * back a stale claim of another process.
+		 * @param totalGames Number of games of the whole match
+		 * @param begin      Receives the number of the first game of the batch
+		 * @param end        Receives the number behind the last game of the batch
+		 * @returns false, if all batches are claimed
+		 */
+		bool claimBatch(uint64_t totalGames, uint64_t& begin, uint64_t& end);
+
+		/**
+		 * Reports a finished game of a claimed batch. Refreshes the claim and marks the batch
+		 * as done after its last game.
+		 */
+		void gameFinished(uint64_t gameNo);
+
+		/**
+		 * Gets the number of batches claimed since the queue has been opened
+		 */
+		uint64_t getClaimedBatches() const {
+			return claimedBatches;
+		}
+
+		/**
+		 * Appends the records of all shard files of filename to filename, ordered by shard number.
+		 * Shards are deleted after they are merged.
+		 * @returns the number of merged games
+		 */
+		static uint64_t mergeShards(const std::string& filename);
+
+		/**
+		 * Removes the shard, claim and done files of a queue directory, thus a new match can use it
+		 * @returns the number of claimed batches that were not done
+		 */
+		static uint64_t reset(const std::string& directory);
+
+	private:
+		/**
+		 * Creates a file, if it does not exist yet. The check and the creation are atomic.
+		 * @returns true, if this call created the file
+		 */
+		bool createExclusive(const std::filesystem::path& path) const;
+
+		/**
+		 * Takes back a batch claimed by another process, if the claim is not done and has not
+		 * been refreshed for staleSeconds
+		 * @returns true, if this process owns the claim now
+		 */
+		bool reclaimStale(uint64_t batchNo);
+
+		bool isStale(const std::filesystem::path& path) const;
+
+		std::filesystem::path getBatchPath(uint64_t batchNo, const char* extension) const {
+			return directory / ("batch-" + std::to_string(batchNo) + extension);
+		}
+
+		/**
+		 * Registers a claimed batch
+		 */
+		void addClaim(uint64_t batchNo, uint64_t totalGames, uint64_t& begin, uint64_t& end);
+
+		static constexpr const char* SHARD_SUFFIX = ".shard";
+		static constexpr const char* LOCK_EXTENSION = ".lock";
+		static constexpr const char* DONE_EXTENSION = ".done";
+
+		std::filesystem::path directory;
+		uint64_t batchSize = 0;
+		uint64_t nextBatch = 0;
+		uint32_t shard = 0;
+		uint32_t staleSeconds = DEFAULT_STALE_SECONDS;
+		// Games not yet finished per claimed batch
+		std::unordered_map<uint64_t, uint64_t> openGames;
+		std::atomic<uint64_t> claimedBatches{ 0 };
+		std::mutex mtx;
+	};
+
+}
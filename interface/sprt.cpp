@@ -0,0 +1,86 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ */
+
+#include <cmath>
+#include "sprt.h"
+
+namespace QaplaInterface {
+
+	double Sprt::eloToScore(double elo) {
+		return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+	}
+
+	double Sprt::computeLLR() const {
+		std::array<double, 5> counts;
+		double pairs = 0;
+		for (size_t index = 0; index < counts.size(); index++) {
+			counts[index] = double(pairCount[index].load(std::memory_order_relaxed));
+			pairs += counts[index];
+		}
+		if (pairs < 2) return 0;
+
+		// Mean and variance of the pair score, scaled to [0, 1]
+		double mean = 0;
+		for (size_t index = 0; index < counts.size(); index++) {
+			mean += counts[index] * double(index) / 4.0;
+		}
+		mean /= pairs;
+		double variance = 0;
+		for (size_t index = 0; index < counts.size(); index++) {
+			const double diff = double(index) / 4.0 - mean;
+			variance += counts[index] * diff * diff;
+		}
+		variance /= pairs;
+		if (variance <= 0) return 0;
+
+		// Gaussian approximation of the log likelihood ratio
+		const double score0 = eloToScore(settings.elo0);
+		const double score1 = eloToScore(settings.elo1);
+		return pairs * (score1 - score0) * (2.0 * mean - score0 - score1) / (2.0 * variance);
+	}
+
+	double Sprt::lowerBound() const {
+		return std::log(settings.beta / (1.0 - settings.alpha));
+	}
+
+	double Sprt::upperBound() const {
+		return std::log((1.0 - settings.beta) / settings.alpha);
+	}
+
+	Sprt::Status Sprt::getStatus() const {
+		const double llr = computeLLR();
+		if (llr >= upperBound()) return Status::ACCEPT_H1;
+		if (llr <= lowerBound()) return Status::ACCEPT_H0;
+		return Status::CONTINUE;
+	}
+
+	void Sprt::print(std::ostream& os) const {
+		const Status status = getStatus();
+		os << "SPRT elo0: " << settings.elo0 << " elo1: " << settings.elo1
+			<< " pairs:";
+		for (const auto& count : pairCount) {
+			os << " " << count.load(std::memory_order_relaxed);
+		}
+		os
+			<< " LLR: " << computeLLR() << " (" << lowerBound() << ", " << upperBound() << ")"
+			<< (status == Status::ACCEPT_H1 ? " H1 accepted" : status == Status::ACCEPT_H0 ? " H0 accepted" : "")
+			<< std::endl;
+	}
+
+}
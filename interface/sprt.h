@@ -0,0 +1,94 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Sequential probability ratio test for self play matches. The games are counted in
+ * pairs of the same opening with switched colors (pentanomial model), because the
+ * results of such a pair are strongly correlated.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+
+namespace QaplaInterface {
+
+	class Sprt {
+	public:
+		enum class Status {
+			CONTINUE, ACCEPT_H0, ACCEPT_H1
+		};
+
+		struct Settings {
+			// Elo difference of the null hypothesis and of the alternative hypothesis
+			double elo0 = 0;
+			double elo1 = 5;
+			// Probability to accept H1, if H0 is true and to accept H0, if H1 is true
+			double alpha = 0.05;
+			double beta = 0.05;
+		};
+
+		Sprt() { clear(); }
+
+		void setSettings(const Settings& settings) {
+			this->settings = settings;
+		}
+
+		const Settings& getSettings() const {
+			return settings;
+		}
+
+		void clear() {
+			for (auto& count : pairCount) count = 0;
+		}
+
+		/**
+		 * Adds the result of a game pair. Thread safe.
+		 * @param halfPoints Half points of the tested engine in both games [0..4]
+		 */
+		void addPair(uint32_t halfPoints) {
+			if (halfPoints < pairCount.size()) {
+				pairCount[halfPoints].fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 * Computes the log likelihood ratio of the pairs counted so far
+		 */
+		double computeLLR() const;
+
+		double lowerBound() const;
+		double upperBound() const;
+
+		/**
+		 * Checks, if the test crossed a bound
+		 */
+		Status getStatus() const;
+
+		void print(std::ostream& os) const;
+
+	private:
+		static double eloToScore(double elo);
+
+		Settings settings;
+		std::array<std::atomic<uint64_t>, 5> pairCount;
+	};
+
+}
@@ -22,26 +22,24 @@
 #include "../training/piece-signature-statistic.h"
 #include "../training/signature-eval-adjuster.h"
 #include "../training/position-filter.h"
+#include "../training/game-replay-engine.h"
 #include "../eval/eval.h"
 #include "winboardprintsearchinfo.h"
+#include "../tests/evalbatchtest.h"
+#include "../tests/positiondatasettest.h"
 #include <thread>
 #include <vector>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sstream>
 
 using namespace std;
 
 using namespace QaplaInterface;
 
-static std::map<std::string, std::vector<uint64_t>> createIndexLookupCount(const ChessEval::IndexLookupMap& original) {
-	std::map<std::string, std::vector<uint64_t>> copy;
-
-	for (const auto& [key, values] : original) {
-		copy[key] = std::vector<uint64_t>(values.size(), 0);
-	}
-
-	return copy;
-}
-
 static std::ostream& formatIndexLookupMap(const std::map<std::string, std::vector<uint64_t>>& map, std::ostream& os) {
 	for (const auto& [key, values] : map) {
 		os << key << ": ";
@@ -59,7 +57,7 @@ static std::ostream& formatIndexLookupMap(const std::map<std::string, std::vecto
 	return os;
 }
 
-static std::ostream& formatMultiplyIndexLookupMap(const ChessEval::IndexLookupMap& map, std::ostream& os) {
+static std::ostream& formatMultiplyIndexLookupMap(const ChessEval::IndexLookupMap& map, std::ostream& os, value_t divisor = 1000) {
 	for (const auto& [key, values] : map) {
 		os << "static constexpr std::array<EvalValue, " << values.size() << "> " << key << "{ {";
 		std::string spacer = "";
@@ -70,7 +68,7 @@ static std::ostream& formatMultiplyIndexLookupMap(const ChessEval::IndexLookupMa
 				lineEnd = ",";
 				spacer = "";
 			}
-			os << spacer << (values[i] / 1000);
+			os << spacer << (values[i] / divisor);
 			spacer = ", ";
 		}
 		os << std::endl << "} };" << std::endl;
@@ -112,6 +110,9 @@ void Statistics::printGameResult(GameResult result) {
 	case GameResult::DRAW_BY_NOT_ENOUGHT_MATERIAL: println("1/2-1/2 {Not enough material to win}"); break;
 	case GameResult::BLACK_WINS_BY_MATE: println("0-1 {Black mates}"); break;
 	case GameResult::WHITE_WINS_BY_MATE: println("1-0 {White mates}"); break;
+	case GameResult::DRAW_BY_ADJUDICATION: println("1/2-1/2 {Draw by adjudication}"); break;
+	case GameResult::BLACK_WINS_BY_ADJUDICATION: println("0-1 {Black wins by adjudication}"); break;
+	case GameResult::WHITE_WINS_BY_ADJUDICATION: println("1-0 {White wins by adjudication}"); break;
 	case GameResult::ILLEGAL_MOVE: println("illegal move"); break;
 	case GameResult::NOT_ENDED: break; // do nothing
 	}
@@ -147,14 +148,65 @@ void Statistics::analyzeMove() {
 	}
 }
 
+/**
+ * Test position of an EPD suite with the expected best moves (bm) and moves to avoid (am)
+ */
+struct EpdTestPosition {
+	std::string epd;
+	std::string id;
+	std::vector<std::string> bestMoves;
+	std::vector<std::string> avoidMoves;
+};
+
+static EpdTestPosition parseEpdTestPosition(const std::string& epd) {
+	EpdTestPosition result;
+	result.epd = epd;
+	std::istringstream in(epd);
+	std::string field;
+	// Board, side to move, castling rights and en passant square
+	for (uint32_t fieldNo = 0; fieldNo < 4 && in >> field; fieldNo++) {}
+	std::string operation;
+	while (std::getline(in, operation, ';')) {
+		std::istringstream operands(operation);
+		std::string opcode;
+		std::string operand;
+		operands >> opcode;
+		while (operands >> operand) {
+			if (opcode == "bm") result.bestMoves.push_back(operand);
+			else if (opcode == "am") result.avoidMoves.push_back(operand);
+			else if (opcode == "id") result.id += (result.id.empty() ? "" : " ") + operand;
+		}
+	}
+	result.id.erase(std::remove(result.id.begin(), result.id.end(), '"'), result.id.end());
+	return result;
+}
+
+/**
+ * Checks, if a move is in a list of SAN moves of the current position of the board
+ */
+static bool containsMove(const std::vector<std::string>& moves, Move move, IChessBoard* board) {
+	return std::any_of(moves.begin(), moves.end(), [&](const std::string& san) {
+		return ChessInterface::findMove(san, board) == move;
+	});
+}
+
+static std::string joinMoves(const std::vector<std::string>& moves) {
+	std::string result;
+	for (const auto& move : moves) {
+		result += (result.empty() ? "" : " ") + move;
+	}
+	return result;
+}
+
 void Statistics::WMTest() {
-	uint32_t numThreads = 16;
+	uint32_t numThreads = std::max(1U, std::thread::hardware_concurrency());
 	uint32_t depthLimit = 10;
-	uint64_t totalNodesSearched = 0;
+	std::string filename = "wmtest.epd";
+	// command line: wmtest [file <epd-filename>] [threads <numThreads>] [sd <depth>] [st <seconds>] [nodes <nodes>]
 	while (getNextTokenNonBlocking() != "") {
 		if (getCurrentToken() == "threads") {
 			if (getNextTokenNonBlocking() != "") {
-				numThreads = (uint32_t)getCurrentTokenAsUnsignedInt();
+				numThreads = std::max(1U, (uint32_t)getCurrentTokenAsUnsignedInt());
 			}
 		}
 		else if (getCurrentToken() == "sd") {
@@ -162,24 +214,235 @@ void Statistics::WMTest() {
 				depthLimit = (uint32_t)getCurrentTokenAsUnsignedInt();
 			}
 		}
-
+		else if (getCurrentToken() == "file") {
+			if (getNextTokenNonBlocking() != "") {
+				filename = getCurrentToken();
+			}
+		}
+		else {
+			checkClockCommands();
+		}
 	}
-	loadEPD("wmtest.epd");
+	loadEPD(filename);
 	_clock.setSearchDepthLimit(depthLimit);
-	getBoard()->setClock(_clock);
+	std::vector<EpdTestPosition> positions;
+	for (const auto& epd : _startPositions) {
+		positions.push_back(parseEpdTestPosition(epd));
+	}
+	numThreads = std::min(numThreads, std::max(1U, uint32_t(positions.size())));
+
+	uint64_t totalNodesSearched = 0;
+	uint64_t totalPawnHashProbes = 0;
+	uint64_t totalPawnHashHits = 0;
+	uint64_t totalLazyEvalExits = 0;
+	uint64_t totalFullEvals = 0;
+	uint32_t rated = 0;
+	uint32_t solved = 0;
+	std::atomic<size_t> nextPosition = 0;
+	std::mutex resultMutex;
 	StdTimeControl timeControl;
 	timeControl.storeStartTime();
-	for (auto& epd : _startPositions) {
-		getBoard()->newGame();
-		ChessInterface::setPositionByFen(epd, getBoard());
-		getBoard()->computeMove();
-		auto info = getBoard()->getComputingInfo();
-		totalNodesSearched += info.nodesSearched;
-		std::cout << epd << " nodes: " << info.nodesSearched << " total: " << totalNodesSearched << std::endl;
-	}
-	std::cout << "Positions searched: " << _startPositions.size() 
+
+	// Every thread searches with an own engine and fetches the next position, when it is done
+	auto worker = [&]() {
+		std::unique_ptr<IChessBoard> engine(getBoard()->createNew());
+		engine->setClock(_clock);
+		for (size_t index = nextPosition++; index < positions.size(); index = nextPosition++) {
+			const auto& position = positions[index];
+			StdTimeControl positionTime;
+			positionTime.storeStartTime();
+			engine->newGame();
+			ChessInterface::setPositionByFen(position.epd, engine.get());
+			engine->computeMove();
+			const uint64_t milliseconds = positionTime.getTimeSpentInMilliseconds();
+			const auto info = engine->getComputingInfo();
+			const Move move = engine->getComputedMove();
+			const bool isRated = !position.bestMoves.empty() || !position.avoidMoves.empty();
+			const bool isSolved = isRated
+				&& (position.bestMoves.empty() || containsMove(position.bestMoves, move, engine.get()))
+				&& !containsMove(position.avoidMoves, move, engine.get());
+
+			std::lock_guard<std::mutex> lock(resultMutex);
+			totalNodesSearched += info.nodesSearched;
+			totalPawnHashProbes += info.pawnHashProbes;
+			totalPawnHashHits += info.pawnHashHits;
+			totalLazyEvalExits += info.lazyEvalExits;
+			totalFullEvals += info.fullEvals;
+			rated += isRated;
+			solved += isSolved;
+			std::cout << (index + 1) << " " << (position.id.empty() ? position.epd : position.id)
+				<< " move: " << move.getLAN();
+			if (!position.bestMoves.empty()) std::cout << " bm: " << joinMoves(position.bestMoves);
+			if (!position.avoidMoves.empty()) std::cout << " am: " << joinMoves(position.avoidMoves);
+			if (isRated) std::cout << (isSolved ? " solved" : " failed");
+			std::cout << " nodes: " << info.nodesSearched
+				<< " time (ms): " << milliseconds
+				<< " nps: " << info.nodesSearched * 1000 / std::max<uint64_t>(1, milliseconds) << std::endl;
+		}
+	};
+	std::vector<std::thread> workers;
+	for (uint32_t threadNo = 1; threadNo < numThreads; threadNo++) {
+		workers.emplace_back(worker);
+	}
+	worker();
+	for (auto& thread : workers) {
+		thread.join();
+	}
+
+	const uint64_t milliseconds = timeControl.getTimeSpentInMilliseconds();
+	std::cout << "Solved: " << solved << "/" << rated << " Threads: " << numThreads << std::endl;
+	std::cout << "Positions searched: " << positions.size()
 		<< " Total nodes searched: " << totalNodesSearched 
-		<< " Time used (s): " << (timeControl.getTimeSpentInMilliseconds() * 1.0 / 1000.0) << std::endl;
+		<< " Time used (s): " << (milliseconds * 1.0 / 1000.0) 
+		<< " NPS: " << totalNodesSearched * 1000 / std::max<uint64_t>(1, milliseconds)
+		<< " Pawn hash hit rate (%): " << (totalPawnHashProbes == 0 ? 0.0 : totalPawnHashHits * 100.0 / totalPawnHashProbes)
+		<< " Lazy eval exits (%): " << (totalLazyEvalExits + totalFullEvals == 0 ? 0.0 : 
+			totalLazyEvalExits * 100.0 / (totalLazyEvalExits + totalFullEvals)) << std::endl;
+}
+
+/**
+ * Positions of the bench command. Changing them changes the bench signature.
+ */
+static const std::array<const char*, 16> BENCH_POSITIONS = {
+	"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+	"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+	"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+	"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+	"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+	"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+	"r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+	"r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 3 9",
+	"2r3k1/pp3ppp/4p3/3nP3/1b1P4/1B6/PP1N1PPP/2R3K1 b - - 0 21",
+	"r2q1rk1/1b1nbppp/pp1ppn2/8/2PNP3/1PN1B3/P3BPPP/R2Q1RK1 w - - 0 11",
+	"3r2k1/p4ppp/1p6/2p5/2P1n3/1P2P1P1/P4PKP/3RB3 b - - 1 27",
+	"8/8/4kpp1/3p1b2/p6P/2B5/6P1/6K1 b - - 0 47",
+	"6k1/5pp1/p3p2p/1p6/2rP4/P1R1P1P1/5PKP/8 w - - 0 33",
+	"8/3k4/8/3PK3/8/8/8/8 w - - 0 1",
+	"5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKN w - - 0 1",
+	"r1b2rk1/2q1b1pp/p2ppn2/1p6/3QP3/1BN1B3/PPP3PP/R4RK1 w - - 0 1",
+};
+
+/**
+ * Endgames of the microbench bitbase probes, the stronger side is white
+ */
+static const std::array<const char*, 16> BITBASE_BENCH_POSITIONS = {
+	"8/8/8/4k3/8/8/4P3/4K3 w - - 0 1",
+	"8/8/8/8/4k3/8/4PK2/8 b - - 0 1",
+	"4k3/8/4K3/4P3/8/8/8/8 w - - 0 1",
+	"8/8/3k4/8/8/3K4/3P4/8 w - - 0 1",
+	"8/1k6/8/1P6/1K6/8/8/8 b - - 0 1",
+	"7k/8/6K1/7P/8/8/8/8 w - - 0 1",
+	"8/8/8/2k5/8/1P6/8/1K6 w - - 0 1",
+	"8/5k2/8/8/2K5/8/6P1/8 b - - 0 1",
+	"8/8/8/8/3k4/8/3p4/R6K w - - 0 1",
+	"8/8/8/8/8/2k5/2p5/K6R b - - 0 1",
+	"1K6/8/8/8/8/4k3/4p3/7R w - - 0 1",
+	"8/8/1R6/8/5K2/8/2kp4/8 b - - 0 1",
+	"8/6R1/8/8/1k6/8/1p6/4K3 w - - 0 1",
+	"6K1/8/8/4k3/4p3/8/8/R7 w - - 0 1",
+	"8/8/8/8/8/1k6/p7/5R1K b - - 0 1",
+	"R7/8/8/8/8/3k1K2/6p1/8 w - - 0 1",
+};
+
+void Statistics::bench() {
+	uint32_t depthLimit = 10;
+	bool json = false;
+	std::string outputFile;
+	// command line: bench [depth <depth>] [json] [output <filename>]
+	while (getNextTokenNonBlocking() != "") {
+		if (getCurrentToken() == "depth") {
+			if (getNextTokenNonBlocking() != "") {
+				depthLimit = std::max(1U, (uint32_t)getCurrentTokenAsUnsignedInt());
+			}
+		}
+		else if (getCurrentToken() == "json") {
+			json = true;
+		}
+		else if (getCurrentToken() == "output") {
+			if (getNextTokenNonBlocking() != "") {
+				outputFile = getCurrentToken();
+			}
+		}
+	}
+	// stdout starts with the version banner, thus parseable output is written to a file
+	std::ofstream file;
+	if (!outputFile.empty()) {
+		file.open(outputFile);
+		if (!file) {
+			std::cerr << "Error: Could not open file " << outputFile << std::endl;
+			return;
+		}
+	}
+	std::ostream& out = outputFile.empty() ? std::cout : file;
+	// A fresh engine with a fixed hash size and a depth limit only, thus the nodes do not depend on earlier commands
+	std::unique_ptr<IChessBoard> engine(getBoard()->createNew());
+	engine->setOption("Hash", "16");
+	ClockSetting clock;
+	clock.setSearchDepthLimit(depthLimit);
+
+	uint64_t totalNodes = 0;
+	StdTimeControl timeControl;
+	timeControl.storeStartTime();
+	if (json) out << "{\"depth\": " << depthLimit << ", \"positions\": [";
+	for (size_t index = 0; index < BENCH_POSITIONS.size(); index++) {
+		StdTimeControl positionTime;
+		positionTime.storeStartTime();
+		engine->newGame();
+		ChessInterface::setPositionByFen(BENCH_POSITIONS[index], engine.get());
+		engine->setClock(clock);
+		engine->computeMove();
+		const uint64_t milliseconds = positionTime.getTimeSpentInMilliseconds();
+		const uint64_t nodes = engine->getComputingInfo().nodesSearched;
+		const std::string move = engine->getComputedMove().getLAN();
+		totalNodes += nodes;
+		if (json) {
+			out << (index == 0 ? "" : ",") << std::endl
+				<< "  {\"fen\": \"" << BENCH_POSITIONS[index] << "\", \"move\": \"" << move
+				<< "\", \"nodes\": " << nodes << ", \"timeMs\": " << milliseconds << "}";
+		}
+		else {
+			out << "Position " << (index + 1) << "/" << BENCH_POSITIONS.size()
+				<< " move: " << move << " nodes: " << nodes << " time (ms): " << milliseconds << std::endl;
+		}
+	}
+	const uint64_t milliseconds = std::max<uint64_t>(1, timeControl.getTimeSpentInMilliseconds());
+	const uint64_t nps = totalNodes * 1000 / milliseconds;
+	if (json) {
+		out << std::endl << "], \"nodes\": " << totalNodes << ", \"timeMs\": " << milliseconds
+			<< ", \"nps\": " << nps << "}" << std::endl;
+	}
+	else {
+		out << "Depth: " << depthLimit << " Time used (ms): " << milliseconds << std::endl;
+		out << "Nodes searched: " << totalNodes << std::endl;
+		out << "Nodes/second: " << nps << std::endl;
+	}
+	if (!outputFile.empty()) {
+		std::cout << "Nodes searched: " << totalNodes << ", results written to " << outputFile << std::endl;
+	}
+}
+
+void Statistics::microbench() {
+	uint32_t warmup = 2;
+	uint32_t repetitions = 5;
+	uint32_t passes = 1000;
+	// command line: microbench [warmup <repetitions>] [reps <repetitions>] [passes <passes per repetition>]
+	while (getNextTokenNonBlocking() != "") {
+		const std::string option = getCurrentToken();
+		if (getNextTokenNonBlocking() == "") break;
+		if (option == "warmup") warmup = uint32_t(getCurrentTokenAsUnsignedInt());
+		else if (option == "reps") repetitions = uint32_t(getCurrentTokenAsUnsignedInt());
+		else if (option == "passes") passes = std::max(1U, uint32_t(getCurrentTokenAsUnsignedInt()));
+	}
+	getBoard()->microbench(std::vector<std::string>(BENCH_POSITIONS.begin(), BENCH_POSITIONS.end()),
+		std::vector<std::string>(BITBASE_BENCH_POSITIONS.begin(), BITBASE_BENCH_POSITIONS.end()),
+		warmup, repetitions, passes);
+}
+
+void Statistics::selfTest() {
+	// command line: selftest
+	const std::vector<std::string> fens(BENCH_POSITIONS.begin(), BENCH_POSITIONS.end());
+	ChessTest::EvalBatchTest().run(fens);
+	ChessTest::PositionDatasetTest().run(fens);
 }
 
 void Statistics::loadGamesFromFile(const std::string& filename) {
@@ -221,67 +484,49 @@ void Statistics::loadGamesFromFile(const std::string& filename) {
 	std::cout << "\rGames loaded: " << count << std::endl;
 }
 
-std::tuple<EvalValue, value_t> Statistics::computeEval(
-	ChessEval::IndexLookupMap& lookupMap, std::map<std::string, std::vector<uint64_t>>& lookupCount, bool verbose) {
-	auto indexVector = getBoard()->computeEvalIndexVector();
-	std::map<std::string, EvalValue> aggregatedValues;
+EvalValue Statistics::computeEval(const ChessEval::FeatureLayout& layout, const ChessEval::FeatureVector& features,
+	const std::vector<EvalValue>& weights, std::vector<uint64_t>& featureCount, bool verbose) {
 
 	EvalValue evalCalculated = 0;
-	int32_t midgame = indexVector[0].index;
-	int32_t midgameV2 = indexVector[1].index;
-	assert(indexVector[0].name == "midgame" && indexVector[1].name == "midgamev2");
-	for (auto& indexInfo : indexVector) {
-		if (indexInfo.name == "midgame" || indexInfo.name == "midgamev2") {
-			continue;
-		}
-		auto index = indexInfo.index;
-		assert(index < lookupMap[indexInfo.name].size());
-		auto& value = lookupMap[indexInfo.name][index];
-		lookupCount[indexInfo.name][indexInfo.index]++;
-		auto valueColor = indexInfo.color == WHITE ? value : -value;
-		evalCalculated += valueColor;
+	for (const auto& feature : features.features) {
+		assert(feature.id < weights.size());
+		const auto& value = weights[feature.id];
+		featureCount[feature.id]++;
+		evalCalculated += feature.color == WHITE ? value : -value;
 		if (verbose) {
-			cout << "sum: " << evalCalculated << " " << indexInfo.name << " value: " << value << " index: " << indexInfo.index << " color: " << (indexInfo.color == WHITE ? "white" : "black") << endl;
-			std::string modifiedName = indexInfo.name.substr(1);
-			aggregatedValues[modifiedName] += valueColor;
-			aggregatedValues[indexInfo.name] += valueColor;
+			cout << "sum: " << evalCalculated << " " << layout.getName(feature.id) << " value: " << value 
+				<< " index: " << layout.getIndex(feature.id) << " color: " << (feature.color == WHITE ? "white" : "black") << endl;
 		}
 	}
-	return std::make_tuple(evalCalculated, midgameV2);
+	return evalCalculated;
 }
 
-void Statistics::trainPosition(ChessEval::IndexLookupMap& lookupMap, int32_t evalDiff) {
-	auto indexVector = getBoard()->computeEvalIndexVector();
-
-	int32_t midgame = indexVector[0].index;
-	int32_t midgameV2 = indexVector[1].index;
-	assert(indexVector[0].name == "midgame" && indexVector[1].name == "midgamev2");
+void Statistics::trainPosition(const ChessEval::FeatureVector& features, std::vector<EvalValue>& weights, int32_t evalDiff) {
+	const int32_t midgameV2 = features.midgameV2InPercent;
 	int32_t eta = std::clamp(evalDiff, -100, 100);
 	EvalValue etaEval(eta * midgameV2 / 100, eta * (100 - midgameV2) / 100);
 
-	for (auto& indexInfo : indexVector) {
-		if (indexInfo.name == "midgame" || indexInfo.name == "midgamev2") {
-			continue;
-		}
-		auto index = indexInfo.index;
-		assert(index < lookupMap[indexInfo.name].size());
-		auto& lookup = lookupMap[indexInfo.name];
-		auto valueEta = (lookup[index].abs() * etaEval)/ 10000;
-		if (indexInfo.color == WHITE) {
-			lookup[index] += etaEval + valueEta;
+	for (const auto& feature : features.features) {
+		assert(feature.id < weights.size());
+		auto& weight = weights[feature.id];
+		auto valueEta = (weight.abs() * etaEval)/ 10000;
+		if (feature.color == WHITE) {
+			weight += etaEval + valueEta;
 		}
 		else {
-			lookup[index] -= etaEval + valueEta;
+			weight -= etaEval + valueEta;
 		}
 	}
 }
 
 void Statistics::train() {
 	loadGamesFromFile("games.txt");
-	auto lookupMap = getBoard()->computeEvalIndexLookupMap();
-	auto trainMap = multiplyIndexLookupMap(lookupMap);
-	formatMultiplyIndexLookupMap(trainMap, std::cout);
-	auto lookupCount = createIndexLookupCount(lookupMap);
+	const auto lookupMap = getBoard()->computeEvalIndexLookupMap();
+	const ChessEval::FeatureLayout layout(lookupMap);
+	const auto weights = layout.flatten(lookupMap);
+	auto trainWeights = layout.flatten(multiplyIndexLookupMap(lookupMap));
+	formatMultiplyIndexLookupMap(layout.unflatten(trainWeights), std::cout);
+	std::vector<uint64_t> featureCount(layout.size(), 0);
 	StdTimeControl timeControl;
 	timeControl.storeStartTime();
 	for (int epoch = 0; epoch < 100; epoch++) {
@@ -294,8 +539,14 @@ void Statistics::train() {
 			gameIndex++;
 			setPositionByFen(game.fen);
 			for (auto& movePair : game.moves) {
-				auto [evalCalculated, midgameV2] = computeEval(lookupMap, lookupCount);
-				auto [evalTrained, midgameV3] = computeEval(trainMap, lookupCount);
+				const auto features = computeFeatureVector(layout);
+				if (features.features.empty()) {
+					std::cerr << "Error: the eval index vector holds no trainable feature" << std::endl;
+					return;
+				}
+				const value_t midgameV2 = features.midgameV2InPercent;
+				EvalValue evalCalculated = computeEval(layout, features, weights, featureCount);
+				EvalValue evalTrained = computeEval(layout, features, trainWeights, featureCount);
 				int32_t eval = getBoard()->eval();
 				int32_t positionValue = movePair.second;
 				std::string move = movePair.first;
@@ -325,7 +576,7 @@ void Statistics::train() {
 						moveCountTest++;
 					}
 					else {
-						trainPosition(trainMap, diff / 1000);
+						trainPosition(features, trainWeights, diff / 1000);
 						difference += std::abs(diff);
 						moveCountTrained++;
 					}
@@ -349,19 +600,245 @@ void Statistics::train() {
 			<< " time spent: " << timeControl.getTimeSpentInMilliseconds() / 1000
 			<< std::endl;
 		if (epoch % 10 == 0) {
-			formatMultiplyIndexLookupMap(trainMap, std::cout);
+			formatMultiplyIndexLookupMap(layout.unflatten(trainWeights), std::cout);
+		}
+	}
+	formatIndexLookupMap(layout.unflatten(featureCount), std::cout);
+	formatMultiplyIndexLookupMap(layout.unflatten(trainWeights), std::cout);
+}
+
+void Statistics::extractTuningData(const ChessEval::FeatureLayout& layout, 
+	const std::vector<EvalValue>& weights, QaplaTraining::TuningDataset& dataset) {
+	std::vector<uint64_t> featureCount(layout.size(), 0);
+	uint64_t skippedPositions = 0;
+	for (auto& game : _games) {
+		setPositionByFen(game.fen);
+		for (auto& [move, value] : game.moves) {
+			if (!getBoard()->isInCheck() && !isCapture(move) && std::abs(value) < MIN_MATE_VALUE) {
+				// The eval is from white perspective, the search value from the perspective of the side to move
+				const value_t positionValue = getBoard()->isWhiteToMove() ? value : -value;
+				if (!addTuningPosition(layout, weights, computeFeatureVector(layout), getBoard()->eval(), 
+					positionValue, featureCount, dataset)) {
+					skippedPositions++;
+				}
+			}
+			if (!handleMove(move)) {
+				break;
+			}
 		}
 	}
-	formatIndexLookupMap(lookupCount, std::cout);
-	formatMultiplyIndexLookupMap(trainMap, std::cout);
+	std::cout << "Positions extracted: " << dataset.size() 
+		<< " skipped (special endgame evaluation): " << skippedPositions << std::endl;
+}
+
+void Statistics::extractTuningData(QaplaTraining::PositionDatasetReader& reader, uint64_t seed, uint32_t numThreads,
+	const ChessEval::FeatureLayout& layout, const std::vector<EvalValue>& weights, QaplaTraining::TuningDataset& dataset) {
+	constexpr size_t BATCH_SIZE = 16384;
+	std::vector<uint64_t> featureCount(layout.size(), 0);
+	uint64_t skippedPositions = 0;
+	std::vector<PositionSnapshot> snapshots;
+	std::vector<value_t> values;
+	auto addBatch = [&]() {
+		const auto results = ChessEval::Eval::evalBatch(snapshots, numThreads, true);
+		for (size_t index = 0; index < results.size(); index++) {
+			// The batch eval is from the perspective of the side to move, the record score from white perspective
+			const value_t whiteEval = snapshots[index].whiteToMove ? results[index].value : -results[index].value;
+			if (!addTuningPosition(layout, weights, layout.toFeatureVector(results[index].indexVector), 
+				whiteEval, values[index], featureCount, dataset)) {
+				skippedPositions++;
+			}
+		}
+		snapshots.clear();
+		values.clear();
+	};
+
+	// The validation share is taken from the end of the dataset, the shuffled pass fills it with positions of many games
+	reader.shuffle(seed);
+	QaplaSearch::BoardAdapter::PositionSetup setup;
+	for (auto record = reader.next(); record != nullptr; record = reader.next()) {
+		if (std::abs(record->score) >= MIN_MATE_VALUE) continue;
+		record->setBoard(&setup);
+		if (!setup.position.isLegal() || setup.position.isInCheck()) continue;
+		snapshots.push_back(setup.position.getSnapshot());
+		values.push_back(record->score);
+		if (snapshots.size() >= BATCH_SIZE) {
+			addBatch();
+		}
+	}
+	addBatch();
+	std::cout << "Positions extracted: " << dataset.size() << " of " << reader.size()
+		<< " skipped (special endgame evaluation): " << skippedPositions << std::endl;
+}
+
+bool Statistics::addTuningPosition(const ChessEval::FeatureLayout& layout, const std::vector<EvalValue>& weights,
+	const ChessEval::FeatureVector& features, value_t whiteEval, value_t whiteValue,
+	std::vector<uint64_t>& featureCount, QaplaTraining::TuningDataset& dataset) {
+	// Larger differences between eval and features indicate a special endgame evaluation
+	constexpr value_t MAX_RESIDUAL = 100;
+	const value_t evalCalculated = computeEval(layout, features, weights, featureCount)
+		.getValue(features.midgameV2InPercent);
+	const value_t residual = whiteEval - evalCalculated;
+	if (std::abs(residual) > MAX_RESIDUAL) {
+		return false;
+	}
+	dataset.add(features, whiteValue, residual);
+	return true;
+}
+
+void Statistics::tune(uint32_t numThreads) {
+	// command line: tune games <games-filename> | positions <position-dataset-filename> [seed <n>] 
+	//   data <dataset-filename> threads <n> epochs <n> batch <n> rate <learning rate>
+	std::string gamesFile = "games.txt";
+	std::string positionsFile;
+	std::string dataFile = "tuning.bin";
+	uint64_t seed = 1;
+	bool gamesGiven = false;
+	QaplaTraining::TexelTuner::Settings settings;
+	settings.threads = numThreads;
+	while (getNextTokenNonBlocking() != "") {
+		const std::string option = getCurrentToken();
+		if (getNextTokenNonBlocking() == "") break;
+		if (option == "games") {
+			gamesFile = getCurrentToken();
+			gamesGiven = true;
+		}
+		else if (option == "positions") positionsFile = getCurrentToken();
+		else if (option == "seed") seed = getCurrentTokenAsUnsignedInt();
+		else if (option == "data") dataFile = getCurrentToken();
+		else if (option == "threads") settings.threads = (uint32_t)getCurrentTokenAsUnsignedInt();
+		else if (option == "epochs") settings.epochs = (uint32_t)getCurrentTokenAsUnsignedInt();
+		else if (option == "batch") settings.batchSize = (uint32_t)getCurrentTokenAsUnsignedInt();
+		else if (option == "rate") settings.learningRate = std::stod(getCurrentToken());
+	}
+
+	const auto lookupMap = getBoard()->computeEvalIndexLookupMap();
+	const ChessEval::FeatureLayout layout(lookupMap);
+	const auto weights = layout.flatten(lookupMap);
+
+	// The feature vectors are extracted once, later runs without a games or positions file read the dataset directly.
+	// A dataset of another format or eval layout is extracted again
+	QaplaTraining::TuningDataset dataset;
+	if (!positionsFile.empty()) {
+		QaplaTraining::PositionDatasetReader reader;
+		if (!reader.open(positionsFile)) {
+			std::cerr << "Error: Could not read position dataset " << positionsFile << std::endl;
+			return;
+		}
+		extractTuningData(reader, seed, settings.threads, layout, weights, dataset);
+		dataset.save(dataFile, layout);
+	}
+	else if (gamesGiven || !dataset.load(dataFile, layout)) {
+		loadGamesFromFile(gamesFile);
+		extractTuningData(layout, weights, dataset);
+		_games.clear();
+		dataset.save(dataFile, layout);
+	}
+
+	QaplaTraining::TexelTuner tuner(weights);
+	tuner.run(dataset, settings, std::cout);
+	formatMultiplyIndexLookupMap(layout.unflatten(tuner.getWeights()), std::cout, 1);
+}
+
+void Statistics::convertGames() {
+	// command line: convert [epd <epd-filename>] games <games-filename> | records <game-record-filename> output <dataset-filename>
+	std::string gamesFile;
+	std::string recordsFile;
+	std::string outputFile = "positions.bin";
+	while (getNextTokenNonBlocking() != "") {
+		const std::string option = getCurrentToken();
+		if (getNextTokenNonBlocking() == "") break;
+		if (option == "games") gamesFile = getCurrentToken();
+		else if (option == "records") recordsFile = getCurrentToken();
+		else if (option == "epd") loadEPD(getCurrentToken());
+		else if (option == "output") outputFile = getCurrentToken();
+	}
+	if (gamesFile.empty() == recordsFile.empty()) {
+		std::cerr << "Error: Specify either a games or a records file" << std::endl;
+		return;
+	}
+	QaplaTraining::PositionDatasetWriter writer;
+	if (!writer.open(outputFile)) {
+		return;
+	}
+	if (!gamesFile.empty()) {
+		convertTextGames(gamesFile, writer);
+	}
+	else {
+		convertGameRecords(recordsFile, writer);
+	}
+	const uint64_t positions = writer.size();
+	if (!writer.close()) {
+		std::cerr << "Error: Could not write " << outputFile << std::endl;
+		return;
+	}
+	std::cout << "Positions written: " << positions << " to " << outputFile << std::endl;
+}
+
+void Statistics::convertTextGames(const std::string& filename, QaplaTraining::PositionDatasetWriter& writer) {
+	loadGamesFromFile(filename);
+	std::vector<QaplaTraining::PackedPosition> gamePositions;
+	for (auto& game : _games) {
+		gamePositions.clear();
+		setPositionByFen(game.fen);
+		for (auto& [move, value] : game.moves) {
+			QaplaTraining::PackedPosition position;
+			if (!position.setFen(getBoard()->getFen())) break;
+			// The search value is from the perspective of the side to move, the eval from white perspective
+			position.score = int16_t(getBoard()->isWhiteToMove() ? value : -value);
+			position.eval = int16_t(getBoard()->eval());
+			gamePositions.push_back(position);
+			if (!handleMove(move)) {
+				break;
+			}
+		}
+		// The text format has no result, games that have not been played to the end keep UNKNOWN
+		const auto result = QaplaTraining::PackedPosition::toPositionResult(getBoard()->getGameResult());
+		for (auto& position : gamePositions) {
+			position.result = result;
+			writer.write(position);
+		}
+	}
+	_games.clear();
+}
+
+void Statistics::convertGameRecords(const std::string& filename, QaplaTraining::PositionDatasetWriter& writer) {
+	QaplaTraining::GameReplayEngine replayEngine(getBoard(), _startPositions);
+	replayEngine.setMoveCallback([&writer](const QaplaTraining::MoveInfo& moveInfo) {
+		if (moveInfo.gameStarting) return;
+		QaplaTraining::PackedPosition position;
+		if (!position.setFen(moveInfo.engine->getFen())) return;
+		position.score = int16_t(moveInfo.engine->isWhiteToMove() ? moveInfo.value : -moveInfo.value);
+		position.eval = int16_t(moveInfo.eval);
+		position.result = QaplaTraining::PackedPosition::toPositionResult(moveInfo.result);
+		writer.write(position);
+	});
+	replayEngine.setFinishCallback([]() {});
+	replayEngine.run(filename);
 }
 
 void Statistics::playEpdGames(uint32_t numThreads) {
 	uint32_t games = 0;
 	uint64_t gpe = 2;
-	// command line: epd file <epd-filename> output <output-filename> threads <numThreads> games <numGames> gpe <games per epd>
+	bool quiet = false;
+	AdjudicationSettings adjudication;
+	bool sprtEnabled = false;
+	Sprt::Settings sprtSettings;
+	uint32_t nodeVariation = 0;
+	uint64_t seed = 0;
+	uint32_t hashSize = 2;
+	bool warm = false;
+	std::string output;
+	std::string queueDirectory;
+	uint64_t batchSize = 64;
+	uint32_t staleSeconds = SelfPlayQueue::DEFAULT_STALE_SECONDS;
+	// command line: epd file <epd-filename> output <output-filename> threads <numThreads> games <numGames> gpe <games per epd> [quiet]
+	// adjudication: winscore <centipawns> winplies <plies> drawmove <move> drawscore <centipawns> drawplies <plies> [bitbase]
+	// sprt: [sprt] elo0 <elo> elo1 <elo> alpha <probability> beta <probability>
+	// node target: nodes <nodes per move> nodesvar <percent> seed <seed>
+	// engines: hash <megabytes> [warm]
+	// distributed: queue <directory shared by all processes> batch <games per claim> stale <seconds until a claim is taken back>
 	while (getNextTokenNonBlocking() != "") {
-		if (checkClockCommands()) {
+		if (checkClockCommands() || checkSprtCommands(sprtEnabled, sprtSettings)) {
 			continue;
 		}
 		if (getCurrentToken() == "threads") {
@@ -376,7 +853,7 @@ void Statistics::playEpdGames(uint32_t numThreads) {
 		}
 		else if (getCurrentToken() == "output") {
 			if (getNextTokenNonBlocking() != "") {
-				epdTasks.setOutputFile(getCurrentToken()); 
+				output = getCurrentToken();
 			}
 		}
 		else if (getCurrentToken() == "games") {
@@ -389,22 +866,139 @@ void Statistics::playEpdGames(uint32_t numThreads) {
 				gpe = static_cast<uint64_t>(getCurrentTokenAsUnsignedInt());
 			}
 		}
+		else if (getCurrentToken() == "quiet") {
+			quiet = true;
+		}
+		else if (getCurrentToken() == "winscore") {
+			if (getNextTokenNonBlocking() != "") {
+				adjudication.winScore = static_cast<value_t>(getCurrentTokenAsUnsignedInt());
+			}
+		}
+		else if (getCurrentToken() == "winplies") {
+			if (getNextTokenNonBlocking() != "") {
+				adjudication.winPlies = static_cast<uint32_t>(getCurrentTokenAsUnsignedInt());
+			}
+		}
+		else if (getCurrentToken() == "drawmove") {
+			if (getNextTokenNonBlocking() != "") {
+				adjudication.drawMove = static_cast<uint32_t>(getCurrentTokenAsUnsignedInt());
+			}
+		}
+		else if (getCurrentToken() == "drawscore") {
+			if (getNextTokenNonBlocking() != "") {
+				adjudication.drawScore = static_cast<value_t>(getCurrentTokenAsUnsignedInt());
+			}
+		}
+		else if (getCurrentToken() == "drawplies") {
+			if (getNextTokenNonBlocking() != "") {
+				adjudication.drawPlies = static_cast<uint32_t>(getCurrentTokenAsUnsignedInt());
+			}
+		}
+		else if (getCurrentToken() == "bitbase") {
+			adjudication.bitbase = true;
+		}
+		else if (getCurrentToken() == "nodesvar") {
+			if (getNextTokenNonBlocking() != "") {
+				nodeVariation = static_cast<uint32_t>(getCurrentTokenAsUnsignedInt());
+			}
+		}
+		else if (getCurrentToken() == "seed") {
+			if (getNextTokenNonBlocking() != "") {
+				seed = getCurrentTokenAsUnsignedInt();
+			}
+		}
+		else if (getCurrentToken() == "hash") {
+			if (getNextTokenNonBlocking() != "") {
+				hashSize = std::max(1U, static_cast<uint32_t>(getCurrentTokenAsUnsignedInt()));
+			}
+		}
+		else if (getCurrentToken() == "warm") {
+			warm = true;
+		}
+		else if (getCurrentToken() == "queue") {
+			if (getNextTokenNonBlocking() != "") {
+				queueDirectory = getCurrentToken();
+			}
+		}
+		else if (getCurrentToken() == "batch") {
+			if (getNextTokenNonBlocking() != "") {
+				batchSize = getCurrentTokenAsUnsignedInt();
+			}
+		}
+		else if (getCurrentToken() == "stale") {
+			if (getNextTokenNonBlocking() != "") {
+				staleSeconds = static_cast<uint32_t>(getCurrentTokenAsUnsignedInt());
+			}
+		}
+	}
+	if (sprtEnabled && gpe < 2) {
+		std::cerr << "Error: sprt needs at least two games per start position (gpe)" << std::endl;
+		return;
 	}
+	// A batch holds all games of its start positions, thus game pairs are never split
+	batchSize = std::max<uint64_t>(1, (batchSize + gpe - 1) / gpe) * gpe;
+	if (!epdTasks.setQueue(queueDirectory, batchSize, staleSeconds)) {
+		return;
+	}
+	if (!output.empty()) {
+		epdTasks.setOutputFile(output);
+	}
+	epdTasks.setQuiet(quiet);
+	epdTasks.setAdjudication(adjudication);
+	epdTasks.setSprt(sprtEnabled, sprtSettings);
+	epdTasks.setCandidateTraining(false);
+	epdTasks.setNodeVariation(nodeVariation);
+	epdTasks.setSeed(seed);
+	epdTasks.setHashSize(hashSize);
+	epdTasks.setWarmEngines(warm);
 	epdTasks.start(numThreads, _clock, _startPositions, getBoard(), games, gpe);
 }
 
+void Statistics::mergeShards() {
+	// command line: mergeshards <game-record-filename> [queue <directory>]
+	if (getNextTokenNonBlocking() == "") {
+		std::cerr << "Error: Specify the game record file" << std::endl;
+		return;
+	}
+	const std::string filename = getCurrentToken();
+	std::string queueDirectory;
+	while (getNextTokenNonBlocking() != "") {
+		if (getCurrentToken() == "queue" && getNextTokenNonBlocking() != "") {
+			queueDirectory = getCurrentToken();
+		}
+	}
+	const uint64_t games = SelfPlayQueue::mergeShards(filename);
+	std::cout << "Merged " << games << " games into " << filename << std::endl;
+	if (!queueDirectory.empty()) {
+		const uint64_t unfinished = SelfPlayQueue::reset(queueDirectory);
+		if (unfinished > 0) {
+			std::cout << "Warning: " << unfinished << " claimed batches were not finished" << std::endl;
+		}
+		std::cout << "Reset queue " << queueDirectory << std::endl;
+	}
+}
+
 /**
  * Improved evaulation weights by candidate pool selection
  */
 void Statistics::trainCandidates(uint32_t numThreads) {
-	if (getNextTokenNonBlocking() != "") {
+	// command line: ct threads <numThreads> [sprt] elo0 <elo> elo1 <elo> alpha <probability> beta <probability>
+	bool sprtEnabled = false;
+	Sprt::Settings sprtSettings;
+	while (getNextTokenNonBlocking() != "") {
+		if (checkSprtCommands(sprtEnabled, sprtSettings)) {
+			continue;
+		}
 		if (getCurrentToken() == "threads") {
 			if (getNextTokenNonBlocking() != "") {
 				numThreads = (uint32_t)getCurrentTokenAsUnsignedInt();
 			}
 		}
 	}
-	//
+	epdTasks.setSprt(sprtEnabled, sprtSettings);
+	epdTasks.setCandidateTraining(true);
+	epdTasks.setWarmEngines(false);
+	epdTasks.setQueue("", 0);
 	CandidateTrainer::initializePopulation();
 
 	while (!CandidateTrainer::finished()) {
@@ -476,6 +1070,10 @@ void Statistics::playStatistic(uint32_t numThreads) {
 		}
 	}
 	_clock.setAnalyseMode();
+	epdTasks.setSprt(false);
+	epdTasks.setCandidateTraining(false);
+	epdTasks.setWarmEngines(false);
+	epdTasks.setQueue("", 0);
 	epdTasks.start(numThreads, _clock, _startPositions, getBoard(), numGames);
 }
 
@@ -540,16 +1138,41 @@ bool Statistics::checkClockCommands() {
 			_clock.setExactTimePerMoveInMilliseconds(getCurrentTokenAsUnsignedInt() * 1000ULL);
 		}
 	}
+	else if (token == "nodes") {
+		if (getNextTokenNonBlocking() != "") {
+			_clock.setNodeCount(getCurrentTokenAsUnsignedInt());
+		}
+	}
 	else {
 		commandProcessed = false;
 	}
 	return commandProcessed;
 }
 
+bool Statistics::checkSprtCommands(bool& enabled, Sprt::Settings& settings) {
+	const string token = getCurrentToken();
+	double* value = nullptr;
+	if (token == "sprt") {
+		enabled = true;
+		return true;
+	}
+	if (token == "elo0") value = &settings.elo0;
+	else if (token == "elo1") value = &settings.elo1;
+	else if (token == "alpha") value = &settings.alpha;
+	else if (token == "beta") value = &settings.beta;
+	else return false;
+	enabled = true;
+	if (getNextTokenNonBlocking() != "") {
+		*value = std::strtod(getCurrentToken().c_str(), nullptr);
+	}
+	return true;
+}
 
-void Statistics::computeMaterialDifference() {
+void Statistics::computeMaterialDifference(uint32_t numThreads) {
+	// command line: material [epd <epd-filename>] [games-file <filename>] [min <n>] [threads <n>] [run] [results]
 	int32_t minAdjust = 0;
 	bool run = false;
+	bool results = false;
 	std::string binaryGamesFile = "epdGames.bin";
 	while (getNextTokenNonBlocking() != "") {
 		if (getCurrentToken() == "epd") {
@@ -567,9 +1190,17 @@ void Statistics::computeMaterialDifference() {
 				minAdjust = (uint32_t)getCurrentTokenAsUnsignedInt();
 			}
 		}
+		else if (getCurrentToken() == "threads") {
+			if (getNextTokenNonBlocking() != "") {
+				numThreads = (uint32_t)getCurrentTokenAsUnsignedInt();
+			}
+		}
 		else if (getCurrentToken() == "run") {
 			run = true;
 		}
+		else if (getCurrentToken() == "results") {
+			results = true;
+		}
 		else {
 			break;
 		}
@@ -579,10 +1210,16 @@ void Statistics::computeMaterialDifference() {
 	QaplaTraining::GameReplayEngine engine(getBoard(), _startPositions);
 	positionFilter.analyzeGames(engine, binaryGamesFile);
 	*/
+	if (results) {
+		QaplaTraining::PieceSignatureStatistic statistic;
+		statistic.run(_startPositions, getBoard(), binaryGamesFile, numThreads);
+		statistic.printResult();
+		return;
+	}
 	QaplaTraining::SignatureEvalAdjuster adjuster(minAdjust);
 
 	if (run) {
-		adjuster.run(_startPositions, getBoard(), binaryGamesFile);
+		adjuster.run(_startPositions, getBoard(), binaryGamesFile, numThreads);
 	}
 	else {
 		adjuster.computeFromFile("signature-eval-adjuster.bin");
@@ -657,13 +1294,19 @@ void Statistics::handleInput() {
 	else if (token == "setboard") setBoard();
 	else if (token == "eval") getBoard()->printEvalInfo();
 	else if (token == "wmtest") WMTest();
+	else if (token == "bench") bench();
+	else if (token == "microbench") microbench();
+	else if (token == "selftest") selfTest();
 	else if (token == "cores") readCores();
 	else if (token == "memory") readMemory();
 	else if (token == "playepd") playEpdGames();
 	else if (token == "playstat") playStatistic();
 	else if (token == "train") train();
+	else if (token == "tune") tune(_maxTheadCount);
+	else if (token == "convert") convertGames();
+	else if (token == "mergeshards") mergeShards();
 	else if (token == "ct") trainCandidates();
 	else if (token == "epd") loadEPD();
-	else if (token == "material") computeMaterialDifference();
+	else if (token == "material") computeMaterialDifference(_maxTheadCount);
 	else if (checkClockCommands()) {}
 }
@@ -27,6 +27,9 @@
 #include "chessinterface.h"
 #include "candidate-trainer.h"
 #include "../search/boardadapter.h"
+#include "../eval/feature-layout.h"
+#include "../training/texel-tuner.h"
+#include "../training/position-dataset.h"
 #include "self-play-manager.h"
 
 using namespace std;
@@ -101,10 +104,28 @@ namespace QaplaInterface {
 		void analyzeMove();
 
 		/**
-		 * Starts a test of a list of EPD strings
+		 * Runs an EPD test suite with one engine per thread. Reports nodes, time and the
+		 * best move compared to the bm and am operations of every position.
 		 */
 		void WMTest();
 
+		/**
+		 * Searches a fixed set of positions single threaded to a fixed depth. The total node count
+		 * identifies the search behavior of a build, the nodes per second its speed.
+		 * With an output file, the results (e.g. as json) are written to the file instead of stdout.
+		 */
+		void bench();
+
+		/**
+		 * Times single hot paths of the engine on the bench positions
+		 */
+		void microbench();
+
+		/**
+		 * Runs the test cases of the tests directory
+		 */
+		void selfTest();
+
 		/**
 		 * Sets the board from fen
 		 */
@@ -120,23 +141,81 @@ namespace QaplaInterface {
 		 */
 		bool checkClockCommands();
 
+		/**
+		 * check command to configure the sprt of a self play match
+		 */
+		bool checkSprtCommands(bool& enabled, Sprt::Settings& settings);
+
 		/**
 		 * Processes any input while computing a move
 		 */
 		void handleInputWhileComputingMove();
 
 		void train();
+
+		/**
+		 * Texel tuning of the eval tables on the positions of a games file or of a position dataset
+		 */
+		void tune(uint32_t numThreads = 1);
+
+		/**
+		 * Replays the loaded games and stores the feature vectors of all quiet positions
+		 */
+		void extractTuningData(const ChessEval::FeatureLayout& layout, 
+			const std::vector<EvalValue>& weights, QaplaTraining::TuningDataset& dataset);
+
+		/**
+		 * Reads the records of a position dataset in a shuffled order, evaluates them in batches
+		 * and stores the feature vectors of all positions not in check. Needs no move replay.
+		 */
+		void extractTuningData(QaplaTraining::PositionDatasetReader& reader, uint64_t seed, uint32_t numThreads,
+			const ChessEval::FeatureLayout& layout, const std::vector<EvalValue>& weights, QaplaTraining::TuningDataset& dataset);
+
+		/**
+		 * Adds a position to the tuning dataset, unless its eval holds a part not covered by the features
+		 * @param whiteEval eval of the position from the view of white
+		 * @param whiteValue search value of the position from the view of white
+		 * @returns false, if the position is skipped
+		 */
+		bool addTuningPosition(const ChessEval::FeatureLayout& layout, const std::vector<EvalValue>& weights,
+			const ChessEval::FeatureVector& features, value_t whiteEval, value_t whiteValue,
+			std::vector<uint64_t>& featureCount, QaplaTraining::TuningDataset& dataset);
+
+		/**
+		 * Converts a text games file or a binary game record file into a position dataset
+		 */
+		void convertGames();
+		void convertTextGames(const std::string& filename, QaplaTraining::PositionDatasetWriter& writer);
+		void convertGameRecords(const std::string& filename, QaplaTraining::PositionDatasetWriter& writer);
+
+		/**
+		 * Merges the shard files of a distributed self play into one game record file
+		 */
+		void mergeShards();
 		void trainCandidates(uint32_t numThreads = 1);
 		void playEpdGames(uint32_t numThreads = 1);
 		void playStatistic(uint32_t numThreads = 1);
 		void loadEPD();
 		void loadEPD(const std::string& filename);
 		void loadGamesFromFile(const std::string& filename);
-		std::tuple<EvalValue, value_t>  computeEval(
-			ChessEval::IndexLookupMap& lookupMap, std::map<std::string, std::vector<uint64_t>>& lookupCount, bool verbose = false);
-		void trainPosition(ChessEval::IndexLookupMap& lookupMap, int32_t evalDiff);
+		/**
+		 * Gets the feature ids of the current position. Always requests every eval feature,
+		 * the default eval index vector only holds the piece signature.
+		 */
+		ChessEval::FeatureVector computeFeatureVector(const ChessEval::FeatureLayout& layout) {
+			return layout.toFeatureVector(getBoard()->computeEvalIndexVector(true));
+		}
+		/**
+		 * Computes the eval of a position from its feature ids and a dense weight vector
+		 */
+		EvalValue computeEval(const ChessEval::FeatureLayout& layout, const ChessEval::FeatureVector& features,
+			const std::vector<EvalValue>& weights, std::vector<uint64_t>& featureCount, bool verbose = false);
+		void trainPosition(const ChessEval::FeatureVector& features, std::vector<EvalValue>& weights, int32_t evalDiff);
 		
-		void computeMaterialDifference();
+		/**
+		 * Replays a binary game file to compute the signature eval adjustments or the result statistic
+		 */
+		void computeMaterialDifference(uint32_t numThreads = 1);
 
 		/**
 		 * Handles input while in "wait for user action" mode
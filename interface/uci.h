@@ -79,11 +79,13 @@ namespace QaplaInterface {
 			println("id name " + getBoard()->getEngineInfo()["name"]);
 			println("id author " + getBoard()->getEngineInfo()["author"]);
 			println("option name Hash type spin default 32 min 1 max 32000");
+			println("option name PawnHash type spin default 1 min 1 max 1024");
 			println("option name ponder type check");
 			println("option name MultiPV type spin default 1 min 1 max 40");
 			println("option name UCI_EngineAbout type string default " + getBoard()->getEngineInfo()["engine-about"]);
 			println("option name qaplaBitbasePath type string");
 			println("option name qaplaBitbaseCache type spin default 8 min 1 max 32000");
+			println("option name qaplaEvalCorrection type string default <empty>");
 			getBoard()->initialize();
 			println("uciok");
 		}
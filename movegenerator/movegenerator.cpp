@@ -68,7 +68,8 @@ void MoveGenerator::computePinnedMask()
 	bitBoard_t ray;
 	bitBoard_t allPieceNoPinned;
 	// Get a mask of all rays starting from the king position until any piece is found
-	ray = Magics::genQueenAttackMask(kingSquares[COLOR], bitBoardAllPieces);
+	const KingRays& kingRays = getKingRays<COLOR>();
+	ray = kingRays.bishop | kingRays.rook;
 	// Create a mask without all pieces that are possibly pinned
 	allPieceNoPinned = bitBoardAllPieces & ~(bitBoardAllPiecesOfOneColor[COLOR] & ray);
 	// Look for all pieces that could pin a piece
@@ -275,8 +276,8 @@ genPawnCaptures(bitBoard_t destinationBB, int32_t moveDirection, MoveList& moveL
 }
 
 template<Piece COLOR>
-void MoveGenerator::
-genEPMove(Square departure, Square epPos, MoveList& moveList)
+bool MoveGenerator::
+isEPMoveLegal(Square departure, Square epPos) const
 {
 	const Piece OPPONENT_COLOR = COLOR == WHITE ? BLACK: WHITE;
 	const Square DIRECTION = COLOR == WHITE ? NORTH : -NORTH;
@@ -294,8 +295,18 @@ genEPMove(Square departure, Square epPos, MoveList& moveList)
 	// Check rooks and queens
 	attack |= Magics::genRookAttackMask(kingSquares[COLOR], allPiecesAfterEPMove) & 
 		(bitBoardsPiece[ROOK + OPPONENT_COLOR] | bitBoardsPiece[QUEEN + OPPONENT_COLOR]);
-	// if king is not in check after move, generate ep move
-	if (!attack)
+	// The ep move is legal, if king is not in check after move
+	return !attack;
+}
+
+template<Piece COLOR>
+void MoveGenerator::
+genEPMove(Square departure, Square epPos, MoveList& moveList)
+{
+	const Piece OPPONENT_COLOR = COLOR == WHITE ? BLACK: WHITE;
+	const Square DIRECTION = COLOR == WHITE ? NORTH : -NORTH;
+
+	if (isEPMoveLegal<COLOR>(departure, epPos))
 	{
 		moveList.addNonSilentMove(
 			Move(departure, epPos + DIRECTION, Move::EP_CODE_UNSHIFTED + PAWN + COLOR, PAWN + OPPONENT_COLOR));
@@ -531,9 +542,10 @@ void MoveGenerator::genEvades(MoveList& moveList)
 	directAttack |= BitBoardMasks::knightMoves[kingSquares[COLOR]] & bitBoardsPiece[KNIGHT + OPPONENT_COLOR];
 
 	// Now check if a range piece is attacking king
-	rangeAttack = Magics::genBishopAttackMask(kingSquares[COLOR], bitBoardAllPieces) & 
+	const KingRays& kingRays = getKingRays<COLOR>();
+	rangeAttack = kingRays.bishop & 
 		(bitBoardsPiece[BISHOP + OPPONENT_COLOR] | bitBoardsPiece[QUEEN + OPPONENT_COLOR]);
-	rangeAttack |= Magics::genRookAttackMask(kingSquares[COLOR], bitBoardAllPieces) &
+	rangeAttack |= kingRays.rook &
 		(bitBoardsPiece[ROOK + OPPONENT_COLOR] | bitBoardsPiece[QUEEN + OPPONENT_COLOR]);
 
 	// Check if more than one piece is attacking the king. If yes we can�t 
@@ -591,14 +603,18 @@ void MoveGenerator::genEvades(MoveList& moveList)
 	
 }
 
+template <Piece COLOR>
+void MoveGenerator::genEvadesOfColor(MoveList& moveList) {
+	computePinnedMask<COLOR>();
+	genEvades<COLOR>(moveList);
+}
+
 void MoveGenerator::genEvadesOfMovingColor(MoveList& moveList) {
 	if (isWhiteToMove()) {
-		computePinnedMask<WHITE>();
-		genEvades<WHITE>(moveList);
+		genEvadesOfColor<WHITE>(moveList);
 	}
 	else {
-		computePinnedMask<BLACK>();
-		genEvades<BLACK>(moveList);
+		genEvadesOfColor<BLACK>(moveList);
 	}
 }
 
@@ -606,7 +622,7 @@ void MoveGenerator::genEvadesOfMovingColor(MoveList& moveList) {
 template <Piece COLOR>
 void MoveGenerator::genNonSilentMoves(MoveList& moveList) {
 	computePinnedMask<COLOR>();
-	if (isInCheck()) {
+	if (isInCheck<COLOR>()) {
 		genEvades<COLOR>(moveList);
 	}
 	else {
@@ -635,7 +651,7 @@ void MoveGenerator::genMoves(MoveList& moveList)
 
 	computePinnedMask<COLOR>();
 
-	if (isInCheck())
+	if (isInCheck<COLOR>())
 	{
 		genEvades<COLOR>(moveList);
 	}
@@ -668,6 +684,166 @@ void MoveGenerator::genMovesOfMovingColor(MoveList& moveList) {
 }
 
 
+// ----------------------------------------------------------------------------
+// -------------------------- Count moves -------------------------------------
+// ----------------------------------------------------------------------------
+
+template <Piece COLOR>
+inline uint32_t MoveGenerator::countPawnTargets(bitBoard_t destinationBB) {
+	const bitBoard_t LAST_ROW = COLOR == WHITE ? BitBoardMasks::RANK_8_BITMASK : BitBoardMasks::RANK_1_BITMASK;
+	// Every promotion counts four moves (queen, rook, bishop, knight)
+	return popCount(destinationBB & ~LAST_ROW) + 4 * popCount(destinationBB & LAST_ROW);
+}
+
+template <Piece COLOR>
+inline uint32_t MoveGenerator::countEPMoves(bitBoard_t pawns, Square epPos) const {
+	uint32_t result = 0;
+	if (epPos) {
+		for (bitBoard_t epPawns = BitBoardMasks::mEPMask[epPos] & pawns; epPawns; epPawns &= epPawns - 1) {
+			result += isEPMoveLegal<COLOR>(lsb(epPawns), epPos);
+		}
+	}
+	return result;
+}
+
+template <Piece COLOR>
+uint32_t MoveGenerator::countEvades()
+{
+	const bitBoard_t RANK_4 = COLOR == WHITE ? BitBoardMasks::RANK_4_BITMASK : BitBoardMasks::RANK_5_BITMASK;
+	const Piece OPPONENT_COLOR = COLOR == WHITE ? BLACK : WHITE;
+
+	bitBoard_t directAttack;
+	bitBoard_t rangeAttack;
+	bitBoard_t possibleTargetPositions;
+	bitBoard_t destination;
+	bitBoard_t removePinnedPiecesMask = ~pinnedMask[COLOR];
+	uint32_t result = 0;
+
+	// Same detection of the checking pieces as in genEvades
+	directAttack = BitBoardMasks::shiftColor<COLOR, NW>(bitBoardsPiece[KING + COLOR]);
+	directAttack |= BitBoardMasks::shiftColor<COLOR, NE>(bitBoardsPiece[KING + COLOR]);
+	directAttack &= bitBoardsPiece[PAWN + OPPONENT_COLOR];
+	directAttack |= BitBoardMasks::knightMoves[kingSquares[COLOR]] & bitBoardsPiece[KNIGHT + OPPONENT_COLOR];
+	const KingRays& kingRays = getKingRays<COLOR>();
+	rangeAttack = kingRays.bishop & 
+		(bitBoardsPiece[BISHOP + OPPONENT_COLOR] | bitBoardsPiece[QUEEN + OPPONENT_COLOR]);
+	rangeAttack |= kingRays.rook &
+		(bitBoardsPiece[ROOK + OPPONENT_COLOR] | bitBoardsPiece[QUEEN + OPPONENT_COLOR]);
+
+	possibleTargetPositions = directAttack | rangeAttack;
+	assert(possibleTargetPositions);
+	// On double check only king moves are possible
+	if ((possibleTargetPositions & possibleTargetPositions - 1) == 0)
+	{
+		if (rangeAttack)
+		{
+			possibleTargetPositions = BitBoardMasks::mRay[kingSquares[COLOR] + lsb(rangeAttack) * 64];
+		}
+		const bitBoard_t pawns = bitBoardsPiece[PAWN + COLOR] & removePinnedPiecesMask;
+		destination = BitBoardMasks::shiftColor<COLOR, NORTH>(pawns) & ~bitBoardAllPieces;
+		result += countPawnTargets<COLOR>(destination & possibleTargetPositions);
+		destination = BitBoardMasks::shiftColor<COLOR, NORTH>(destination) & RANK_4 & ~bitBoardAllPieces;
+		result += popCount(destination & possibleTargetPositions);
+
+		const bitBoard_t captureTargets = possibleTargetPositions & bitBoardAllPiecesOfOneColor[OPPONENT_COLOR];
+		result += countPawnTargets<COLOR>(BitBoardMasks::shiftColor<COLOR, NW>(pawns) & captureTargets);
+		result += countPawnTargets<COLOR>(BitBoardMasks::shiftColor<COLOR, NE>(pawns) & captureTargets);
+		result += countEPMoves<COLOR>(pawns, getEP());
+
+		bitBoard_t pieces = bitBoardAllPiecesOfOneColor[COLOR] & ~bitBoardsPiece[PAWN + COLOR] & 
+			~bitBoardsPiece[KING + COLOR] & removePinnedPiecesMask;
+		for (; pieces; pieces &= pieces - 1) {
+			result += popCount(pieceAttackMask[lsb(pieces)] & possibleTargetPositions);
+		}
+	}
+	result += popCount(pieceAttackMask[kingSquares[COLOR]] & ~bitBoardAllPiecesOfOneColor[COLOR] & ~attackMask[OPPONENT_COLOR]);
+	return result;
+}
+
+template<Piece COLOR>
+uint32_t MoveGenerator::countPinnedMoves(Square epPos) const
+{
+	const bitBoard_t RANK_4 = COLOR == WHITE ? BitBoardMasks::RANK_4_BITMASK : BitBoardMasks::RANK_5_BITMASK;
+	uint32_t result = 0;
+
+	for (bitBoard_t pieces = pinnedMask[COLOR] & bitBoardAllPiecesOfOneColor[COLOR]; pieces; pieces &= pieces - 1)
+	{
+		const Square departure = lsb(pieces);
+		const bitBoard_t allowedRayMask = BitBoardMasks::mFullRay[kingSquares[COLOR] + departure * 64] & pinnedMask[COLOR];
+		switch (operator[](departure)) {
+		// Pinned KNIGHTS can never move.
+		case PAWN + COLOR:
+		{
+			// A pinned pawn pushed along the pinning ray never promotes
+			bitBoard_t destination = BitBoardMasks::shiftColor<COLOR, NORTH>(1ULL << departure) & ~bitBoardAllPieces & allowedRayMask;
+			result += popCount(destination);
+			destination = BitBoardMasks::shiftColor<COLOR, NORTH>(destination) & ~bitBoardAllPieces & allowedRayMask & RANK_4;
+			result += popCount(destination);
+			result += countPawnTargets<COLOR>(BitBoardMasks::pawnCaptures[COLOR][departure] & allowedRayMask & bitBoardAllPieces);
+			result += countEPMoves<COLOR>(1ULL << departure, epPos);
+			break;
+		}
+		case BISHOP + COLOR:
+		case ROOK + COLOR:
+		case QUEEN + COLOR:
+			result += popCount(pieceAttackMask[departure] & allowedRayMask);
+			break;
+		default:
+			// Intentionally left blank
+			break;
+		}
+	}
+	return result;
+}
+
+template <Piece COLOR>
+uint32_t MoveGenerator::countMoves()
+{
+	const Piece OPPONENT_COLOR = COLOR == WHITE ? BLACK : WHITE;
+	const bitBoard_t RANK_4 = COLOR == WHITE ? BitBoardMasks::RANK_4_BITMASK : BitBoardMasks::RANK_5_BITMASK;
+
+	computePinnedMask<COLOR>();
+	if (isInCheck<COLOR>()) {
+		return countEvades<COLOR>();
+	}
+
+	uint32_t result = 0;
+	const bitBoard_t pawns = bitBoardsPiece[PAWN + COLOR] & ~pinnedMask[COLOR];
+	bitBoard_t destination = BitBoardMasks::shiftColor<COLOR, NORTH>(pawns) & ~bitBoardAllPieces;
+	result += countPawnTargets<COLOR>(destination);
+	destination = BitBoardMasks::shiftColor<COLOR, NORTH>(destination) & ~bitBoardAllPieces & RANK_4;
+	result += popCount(destination);
+	result += countPawnTargets<COLOR>(BitBoardMasks::shiftColor<COLOR, NW>(pawns) & bitBoardAllPiecesOfOneColor[OPPONENT_COLOR]);
+	result += countPawnTargets<COLOR>(BitBoardMasks::shiftColor<COLOR, NE>(pawns) & bitBoardAllPiecesOfOneColor[OPPONENT_COLOR]);
+	result += countEPMoves<COLOR>(pawns, getEP());
+
+	bitBoard_t pieces = bitBoardAllPiecesOfOneColor[COLOR] & ~bitBoardsPiece[PAWN + COLOR] &
+		~bitBoardsPiece[KING + COLOR] & ~pinnedMask[COLOR];
+	for (; pieces; pieces &= pieces - 1) {
+		result += popCount(pieceAttackMask[lsb(pieces)] & ~bitBoardAllPiecesOfOneColor[COLOR]);
+	}
+	result += popCount(pieceAttackMask[kingSquares[COLOR]] & ~bitBoardAllPiecesOfOneColor[COLOR] & ~attackMask[OPPONENT_COLOR]);
+
+	if (isKingSideCastleAllowed<COLOR>() && (attackMask[OPPONENT_COLOR] & castleAttackMaskKingSide[COLOR]) == 0 &&
+		(castlePieceMaskKingSide[COLOR] & bitBoardAllPieces) == 0)
+		result++;
+	if (isQueenSideCastleAllowed<COLOR>() && (attackMask[OPPONENT_COLOR] & castleAttackMaskQueenSide[COLOR]) == 0 &&
+		(castlePieceMaskQueenSide[COLOR] & bitBoardAllPieces) == 0)
+		result++;
+
+	result += countPinnedMoves<COLOR>(getEP());
+	return result;
+}
+
+uint32_t MoveGenerator::countLegalMoves() {
+	if (isWhiteToMove()) {
+		return countMoves<WHITE>();
+	}
+	else {
+		return countMoves<BLACK>();
+	}
+}
+
 template <Piece COLOR>
 std::array<bitBoard_t, Piece::PIECE_AMOUNT / 2> MoveGenerator::computeCheckBitmaps() const {
 	array<bitBoard_t, Piece::PIECE_AMOUNT / 2> result;
@@ -678,8 +854,9 @@ std::array<bitBoard_t, Piece::PIECE_AMOUNT / 2> MoveGenerator::computeCheckBitma
 	// Compute all squares where a piece can check the king
 	result[PAWN >> 1] = BitBoardMasks::shiftColor<COLOR, NW>(kingBB) | BitBoardMasks::shiftColor<COLOR, NE>(kingBB);
 	result[KNIGHT >> 1] = BitBoardMasks::knightMoves[kingPos];
-	result[BISHOP >> 1] = Magics::genBishopAttackMask(kingPos, bitBoardAllPieces);
-	result[ROOK >> 1] = Magics::genRookAttackMask(kingPos, bitBoardAllPieces);
+	const KingRays& kingRays = getKingRays<COLOR>();
+	result[BISHOP >> 1] = kingRays.bishop;
+	result[ROOK >> 1] = kingRays.rook;
 	const auto queenMovesFromKingPosition = result[ROOK >> 1] | result[BISHOP >> 1];
 	result[QUEEN >> 1] = queenMovesFromKingPosition;
 	result[KING >> 1] = 0;
@@ -788,5 +965,11 @@ bool MoveGenerator::isCheckMove(Move move, const std::array<bitBoard_t, Piece::P
 
 template void MoveGenerator::genMoves<WHITE>(MoveList&);
 template void MoveGenerator::genMoves<BLACK>(MoveList&);
+template void MoveGenerator::genNonSilentMoves<WHITE>(MoveList&);
+template void MoveGenerator::genNonSilentMoves<BLACK>(MoveList&);
+template void MoveGenerator::genEvadesOfColor<WHITE>(MoveList&);
+template void MoveGenerator::genEvadesOfColor<BLACK>(MoveList&);
+template std::array<bitBoard_t, Piece::PIECE_AMOUNT / 2> MoveGenerator::computeCheckBitmaps<WHITE>() const;
+template std::array<bitBoard_t, Piece::PIECE_AMOUNT / 2> MoveGenerator::computeCheckBitmaps<BLACK>() const;
 template void MoveGenerator::genPinnedMovesForAllPieces<WHITE>(MoveList&, Square);
 template void MoveGenerator::genPinnedMovesForAllPieces<BLACK>(MoveList&, Square);
\ No newline at end of file
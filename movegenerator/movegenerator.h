@@ -39,6 +39,17 @@ using namespace QaplaBasics;
 
 namespace QaplaMoveGenerator {
 
+	/**
+	 * Bishop and rook rays from a king square on the full occupancy together with the
+	 * key (occupancy, king square) they have been computed for
+	 */
+	struct KingRays {
+		bitBoard_t occupied = 0;
+		Square kingSquare = NO_SQUARE;
+		bitBoard_t bishop = 0;
+		bitBoard_t rook = 0;
+	};
+
 	class MoveGenerator : public Board
 	{
 	public:
@@ -48,14 +59,15 @@ namespace QaplaMoveGenerator {
 		 * Returns true, if the side to move is in check
 		 */
 		inline bool isInCheck() {
-			bool result;
-			if (isWhiteToMove()) {
-				result = (bitBoardsPiece[WHITE_KING] & attackMask[BLACK]) != 0;
-			}
-			else {
-				result = (bitBoardsPiece[BLACK_KING] & attackMask[WHITE]) != 0;
-			}
-			return result;
+			return isWhiteToMove() ? isInCheck<WHITE>() : isInCheck<BLACK>();
+		}
+
+		/**
+		 * Returns true, if the king of COLOR is in check
+		 */
+		template <Piece COLOR>
+		inline bool isInCheck() const {
+			return (bitBoardsPiece[KING + COLOR] & attackMask[opponentColor<COLOR>()]) != 0;
 		}
 
 		/**
@@ -111,6 +123,14 @@ namespace QaplaMoveGenerator {
 			}
 		}
 
+		/**
+		 * Restores the position from a snapshot and recomputes the attack masks
+		 */
+		void setFromSnapshot(const PositionSnapshot& snapshot) {
+			Board::setFromSnapshot(snapshot);
+			computeAttackMasksForBothColors();
+		}
+
 		/**
 	     * Creates a symetric board exchanging black/white side
 	     */
@@ -130,6 +150,12 @@ namespace QaplaMoveGenerator {
 
 		std::array<bitBoard_t, Piece::PIECE_AMOUNT / 2> computeCheckBitmapsForMovingColor() const;
 
+		/**
+		 * Returns the check bitmaps against the king of KING_COLOR
+		 */
+		template <Piece KING_COLOR>
+		std::array<bitBoard_t, Piece::PIECE_AMOUNT / 2> computeCheckBitmaps() const;
+
 		bool isCheckMove(Move move, const std::array<bitBoard_t, Piece::PIECE_AMOUNT / 2>& checkingBitmaps);
 
 		/**
@@ -147,6 +173,26 @@ namespace QaplaMoveGenerator {
 		 */
 		void genNonSilentMovesOfMovingColor(MoveList& moveList);
 
+		/**
+		 * Generates all moves (silent and non silent), all non silent moves or all check evades
+		 * of COLOR. COLOR must be the color to move.
+		 */
+		template <Piece COLOR>
+		void genMovesOfColor(MoveList& moveList) { genMoves<COLOR>(moveList); }
+
+		template <Piece COLOR>
+		void genNonSilentMovesOfColor(MoveList& moveList) { genNonSilentMoves<COLOR>(moveList); }
+
+		template <Piece COLOR>
+		void genEvadesOfColor(MoveList& moveList);
+
+		/**
+		 * Counts all legal moves of the color to move without generating them.
+		 * Destination bitboards are popcounted per piece, pins and check evasions
+		 * are handled like in genMovesOfMovingColor
+		 */
+		uint32_t countLegalMoves();
+
 		/**
 		 * Sets a new piece to the board
 		 */
@@ -173,6 +219,24 @@ namespace QaplaMoveGenerator {
 		template <Piece COLOR>
 		void computePinnedMask();
 
+		/**
+		 * Gets the bishop and rook rays from the king of COLOR. Shared by pin detection, 
+		 * check evasion, check detection and the king attack eval. The rays are cached and 
+		 * only recomputed, if the occupancy or the king square changed since the last call
+		 */
+		template <Piece COLOR>
+		inline const KingRays& getKingRays() const {
+			KingRays& rays = kingRaysCache[COLOR];
+			const Square kingSquare = kingSquares[COLOR];
+			if (rays.occupied != bitBoardAllPieces || rays.kingSquare != kingSquare) {
+				rays.occupied = bitBoardAllPieces;
+				rays.kingSquare = kingSquare;
+				rays.bishop = Magics::genBishopAttackMask(kingSquare, bitBoardAllPieces);
+				rays.rook = Magics::genRookAttackMask(kingSquare, bitBoardAllPieces);
+			}
+			return rays;
+		}
+
 		// ------------------------------------------------------------------------
 		// ---------------------- Gives check -------------------------------------
 		// ------------------------------------------------------------------------
@@ -191,6 +255,9 @@ namespace QaplaMoveGenerator {
 		 */ 
 		void genMovesMultiplePieces(uint32_t piece, int32_t aStep, bitBoard_t destinationBB, MoveList& moveList);
 
+		template<Piece COLOR>
+		bool isEPMoveLegal(Square startPos, Square epPos) const;
+
 		template<Piece COLOR>
 		void genEPMove(Square startPos, Square epPos, MoveList& moveList);
 
@@ -238,6 +305,21 @@ namespace QaplaMoveGenerator {
 		template <Piece COLOR>
 		void genMoves(MoveList& moveList);
 
+		template <Piece COLOR>
+		static uint32_t countPawnTargets(bitBoard_t destinationBB);
+
+		template <Piece COLOR>
+		uint32_t countEPMoves(bitBoard_t pawns, Square epPos) const;
+
+		template <Piece COLOR>
+		uint32_t countEvades();
+
+		template <Piece COLOR>
+		uint32_t countPinnedMoves(Square epPos) const;
+
+		template <Piece COLOR>
+		uint32_t countMoves();
+
 		template<Piece PIECE>
 		bitBoard_t computeAttackMaskForPiece(Square square, bitBoard_t allPiecesWithoutKing);
 
@@ -250,11 +332,11 @@ namespace QaplaMoveGenerator {
 		template <Piece COLOR>
 		void computeCastlingMasksForMoveGeneration();
 
-		template <Piece COLOR>
-		std::array<bitBoard_t, Piece::PIECE_AMOUNT / 2> computeCheckBitmaps() const;
-
 		static const int32_t ONE_COLUMN = 1;
 
+		// Cache for getKingRays
+		mutable array<KingRays, 2> kingRaysCache;
+
 	public:
 
 		// Squares attacked by any piece
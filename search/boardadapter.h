@@ -32,8 +32,11 @@
 #include "../basics/movelist.h"
 #include "../movegenerator/movegenerator.h"
 #include "../search/perft.h"
+#include "../search/microbench.h"
+#include "../interface/fenscanner.h"
 #include "../search/search.h"
 #include "../eval/eval.h"
+#include "../eval/signature-correction.h"
 #include "../search/iterativedeepening.h"
 #include "movehistory.h"
 #include "../bitbase/bitbase.h"
@@ -98,11 +101,22 @@ namespace QaplaSearch {
 					QaplaBitbase::BitbaseReader::setBitbasePath(value);
 					return;
 				}
+				if (name == "qaplaEvalCorrection") {
+					if (value == "" || value == "<empty>") {
+						SignatureCorrection::clear();
+					}
+					else if (SignatureCorrection::loadFromFile(value)) {
+						std::cout << "info string eval correction loaded from " << value << std::endl;
+					}
+					iterativeDeepening.clearMemories();
+					return;
+				}
 				auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), intValue);
 				if (ec != std::errc()) {
 					return;
 				}
 				if (name == "Hash") iterativeDeepening.setTTSizeInKilobytes(intValue * 1024);
+				if (name == "PawnHash") iterativeDeepening.setPawnTTSizeInKilobytes(std::clamp(intValue, 1, 1024) * 1024);
 				if (name == "MultiPV") iterativeDeepening.setMultiPV(std::clamp(intValue, 1, 40));
 				if (name == "qaplaBitbaseCache") QaplaBitbase::Bitbase::setCacheSize(intValue);
 			}
@@ -156,6 +170,10 @@ namespace QaplaSearch {
 			iterativeDeepening.startNewGame();
 		}
 
+		virtual void newGameKeepHash() {
+			iterativeDeepening.startNewGameKeepHash();
+		}
+
 		/**
 		 * Playes a move. Only the destination square must be provided, other information must be provided
 		 * only to solve anbiguity. 
@@ -171,17 +189,51 @@ namespace QaplaSearch {
 			uint32_t destinationFile, uint32_t destinationRank,
 			char promotePiece)
 		{
-			Move move = findMove(position, movingPiece, departureFile, departureRank,
-				destinationFile, destinationRank, promotePiece);
+			// findMove only returns legal moves
+			return applyMove(findMove(position, movingPiece, departureFile, departureRank,
+				destinationFile, destinationRank, promotePiece));
+		};
 
-			if (!move.isEmpty()) {
-				position.doMove(move);
-				moveHistory.addMove(move);
-				playedMovesInGame++;
+		/**
+		 * Playes a move generated for the current position
+		 * @returns false and leaves the position unchanged, if the move is not legal in the current position
+		 */
+		virtual bool doMove(Move move) {
+			if (!isLegalMove(position, move)) {
+				return false;
 			}
+			return applyMove(move);
+		}
 
-			return !move.isEmpty();
-		};
+		/**
+		 * Finds the legal move from departure to destination square
+		 */
+		virtual Move findMove(uint32_t departure, uint32_t destination, char promotePiece) {
+			return findMove(position, 0, departure % 8, departure / 8,
+				destination % 8, destination / 8, promotePiece);
+		}
+
+		/**
+		 * Finds a legal move from partial information
+		 */
+		virtual Move findMove(char movingPiece,
+			uint32_t departureFile, uint32_t departureRank,
+			uint32_t destinationFile, uint32_t destinationRank,
+			char promotePiece)
+		{
+			return findMove(position, movingPiece, departureFile, departureRank,
+				destinationFile, destinationRank, promotePiece);
+		}
+
+		/**
+		 * Gets the best move of the last search
+		 */
+		virtual Move getComputedMove() {
+			if (_computingInfo.getMovesAmount() == 0) {
+				return Move();
+			}
+			return _computingInfo.getPV().getMove(0);
+		}
 
 		virtual bool isCapture(char movingPiece,
 			uint32_t departureFile, uint32_t departureRank,
@@ -197,7 +249,7 @@ namespace QaplaSearch {
 		 * Undoes the last move
 		 */
 		virtual void undoMove() {
-			position = moveHistory.undoMove();
+			moveHistory.undoMove(position);
 			if (playedMovesInGame > 0) {
 				playedMovesInGame--;
 			}
@@ -309,6 +361,28 @@ namespace QaplaSearch {
 			return res;
 		}
 
+		/**
+		 * Starts the micro benchmarks
+		 */
+		virtual void microbench(const std::vector<std::string>& fens, const std::vector<std::string>& bitbaseFens, 
+			uint32_t warmup, uint32_t repetitions, uint32_t passes) {
+			auto setup = [](const std::vector<std::string>& fens) {
+				std::vector<MoveGenerator> positions;
+				PositionSetup setup;
+				for (const auto& fen : fens) {
+					if (FenScanner().setBoard(fen, &setup)) {
+						positions.push_back(setup.position);
+					}
+				}
+				return positions;
+			};
+			MicroBench::Settings settings;
+			settings.warmup = warmup;
+			settings.repetitions = repetitions;
+			settings.passes = passes;
+			MicroBench(setup(fens), setup(bitbaseFens), settings).run(std::cout);
+		}
+
 		/**
 		 * Provides the result of the game
 		 */
@@ -326,6 +400,23 @@ namespace QaplaSearch {
 			return result;
 		}
 
+		/**
+		 * Looks the current position up in the loaded bitbases
+		 */
+		virtual GameResult getBitbaseResult() {
+			const bool whiteToMove = position.isWhiteToMove();
+			switch (QaplaBitbase::BitbaseReader::getValueFromBitbase(position)) {
+			case QaplaBitbase::Result::Win:
+				return whiteToMove ? GameResult::WHITE_WINS_BY_ADJUDICATION : GameResult::BLACK_WINS_BY_ADJUDICATION;
+			case QaplaBitbase::Result::Loss:
+				return whiteToMove ? GameResult::BLACK_WINS_BY_ADJUDICATION : GameResult::WHITE_WINS_BY_ADJUDICATION;
+			case QaplaBitbase::Result::Draw:
+				return GameResult::DRAW_BY_ADJUDICATION;
+			default:
+				return GameResult::NOT_ENDED;
+			}
+		}
+
 		/**
 		 * Force the engine to play the move now
 		 */
@@ -418,12 +509,17 @@ namespace QaplaSearch {
 			if (feature == "random") {
 				position.setRandomBonus(value);
 			}
+			else if (feature == "randomseed") {
+				// Set per game; the new game decides, if the hash is kept
+				position.setRandomSeed(uint64_t(uint32_t(value)));
+				return;
+			}
 			iterativeDeepening.clearMemories();
 		};
 
-		virtual IndexVector computeEvalIndexVector() {
+		virtual IndexVector computeEvalIndexVector(bool allFeatures = false) {
 			Eval eval;
-			return eval.computeIndexVector(position);
+			return eval.computeIndexVector(position, allFeatures);
 		}
 
 		virtual IndexLookupMap computeEvalIndexLookupMap() {
@@ -486,18 +582,73 @@ namespace QaplaSearch {
 			moveHistory.print();
 		}
 
+		/**
+		 * Board setup functions used by the FenScanner and the position dataset to set up a 
+		 * plain MoveGenerator, without the search and hash of a BoardAdapter
+		 */
+		struct PositionSetup {
+			void clearBoard() { position.clear(); }
+			void setPiece(uint32_t file, uint32_t rank, char piece) {
+				const File castFile = static_cast<File>(file);
+				const Rank castRank = static_cast<Rank>(rank);
+				if (isFileInBoard(castFile) && isRankInBoard(castRank)) {
+					position.setPiece(computeSquare(castFile, castRank), charToPiece(piece));
+				}
+			}
+			void setWhiteToMove(bool whiteToMove) { position.setWhiteToMove(whiteToMove); }
+			void setWhiteQueenSideCastlingRight(bool allow) { position.setCastlingRight(WHITE, false, allow); }
+			void setWhiteKingSideCastlingRight(bool allow) { position.setCastlingRight(WHITE, true, allow); }
+			void setBlackQueenSideCastlingRight(bool allow) { position.setCastlingRight(BLACK, false, allow); }
+			void setBlackKingSideCastlingRight(bool allow) { position.setCastlingRight(BLACK, true, allow); }
+			void setEPSquare(uint32_t epFile, uint32_t epRank) {
+				// Stored as position of the pawn to capture
+				position.setEP(computeSquare(File(epFile), Rank(epRank == 3 ? 4 : 5)));
+			}
+			void setHalfmovesWithoutPawnMoveOrCapture(uint16_t number) { position.setFenHalfmovesWihtoutPawnMoveOrCapture(number); }
+			void setPlayedMovesInGame(uint16_t) {}
+			void finishBoardSetup() {}
+
+			MoveGenerator position;
+		};
+
 	private:
 
+		/**
+		 * Plays a move known to be legal
+		 */
+		bool applyMove(Move move) {
+			if (move.isEmpty()) {
+				return false;
+			}
+			moveHistory.addMove(position, move);
+			position.doMove(move);
+			playedMovesInGame++;
+			return true;
+		}
 
 		/**
-		 * Checks, if we have a mate situation
+		 * Checks, if the move is in the list of legal moves of the position
 		 */
-		GameResult isMateOrStalemate(MoveGenerator& position) {
-			GameResult result = GameResult::NOT_ENDED;
+		static bool isLegalMove(MoveGenerator& position, Move move) {
+			if (move.isEmpty()) {
+				return false;
+			}
 			MoveList moveList;
 			position.genMovesOfMovingColor(moveList);
+			for (uint32_t moveNo = 0; moveNo < moveList.getTotalMoveAmount(); moveNo++) {
+				if (moveList[moveNo] == move) {
+					return true;
+				}
+			}
+			return false;
+		}
 
-			if (moveList.getTotalMoveAmount() == 0) {
+		/**
+		 * Checks, if we have a mate situation
+		 */
+		GameResult isMateOrStalemate(MoveGenerator& position) {
+			GameResult result = GameResult::NOT_ENDED;
+			if (position.countLegalMoves() == 0) {
 				if (position.isWhiteToMove()) {
 					if (position.isInCheck()) {
 						result = GameResult::BLACK_WINS_BY_MATE;
@@ -61,6 +61,23 @@ namespace QaplaSearch {
 			_hashFullInPermill = hashFull;
 		}
 
+		/**
+		 * Sets the amount of pawn hash probes and hits of the current search
+		 */
+		void setPawnHashStatistic(uint64_t probes, uint64_t hits) {
+			_pawnHashProbes = probes;
+			_pawnHashHits = hits;
+		}
+
+		/**
+		 * Sets the amount of quiescence evaluations returning after the material stage 
+		 * and the amount of full evaluations of the current search
+		 */
+		void setEvalStageStatistic(uint64_t lazyEvalExits, uint64_t fullEvals) {
+			_lazyEvalExits = lazyEvalExits;
+			_fullEvals = fullEvals;
+		}
+
 		uint32_t getMultiPV() const {
 			return _multiPV;
 		}
@@ -85,6 +102,10 @@ namespace QaplaSearch {
 			_searchDepth = 0;
 			_nodesSearched = 0;
 			_tbHits = 0;
+			_pawnHashProbes = 0;
+			_pawnHashHits = 0;
+			_lazyEvalExits = 0;
+			_fullEvals = 0;
 			_totalAmountOfMovesToConcider = 0;
 			_currentMoveNoSearched = 0;
 			_positionValueInCentiPawn = 0;
@@ -251,7 +272,13 @@ namespace QaplaSearch {
 			exchange.elapsedTimeInMilliseconds = _timeControl.getTimeSpentInMilliseconds();
 			exchange.totalAmountOfMovesToConcider = _totalAmountOfMovesToConcider;
 			exchange.movesLeftToConcider = _totalAmountOfMovesToConcider - _currentMoveNoSearched - 1;
-			exchange.valueInCentiPawn = _positionValueInCentiPawn;
+			// An iteration aborted before its first result keeps the value of the last finished iteration
+			exchange.valueInCentiPawn = _positionValueInCentiPawn != -MAX_VALUE ? 
+				_positionValueInCentiPawn : getPVMoveValueInCentiPawn(0);
+			exchange.pawnHashProbes = _pawnHashProbes;
+			exchange.pawnHashHits = _pawnHashHits;
+			exchange.lazyEvalExits = _lazyEvalExits;
+			exchange.fullEvals = _fullEvals;
 			return exchange;
 		}
 
@@ -304,6 +331,10 @@ namespace QaplaSearch {
 		value_t _positionValueInCentiPawn;
 		uint32_t _totalAmountOfMovesToConcider;
 		uint32_t _hashFullInPermill;
+		uint64_t _pawnHashProbes;
+		uint64_t _pawnHashHits;
+		uint64_t _lazyEvalExits;
+		uint64_t _fullEvals;
 		Move _currentConcideredMove;
 		uint32_t _currentMoveNoSearched;
 		uint32_t _searchDepth;
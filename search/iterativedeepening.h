@@ -57,6 +57,14 @@ namespace QaplaSearch {
 			clearMemories();
 		}
 
+		/**
+		 * Starts a new game without clearing the hash. The age bump lets the new game
+		 * replace entries of former games first.
+		 */
+		void startNewGameKeepHash() {
+			_tt.setNextSearch();
+		}
+
 		/**
 		 * Clears the hash for example on a new game
 		 */
@@ -79,6 +87,13 @@ namespace QaplaSearch {
 			_tt.setSizeInKilobytes(size);
 		}
 
+		/**
+		 * Sets the size of the pawn transposition table in kilobytes
+		 */
+		void setPawnTTSizeInKilobytes(int32_t size) {
+			_tt.setPawnTTSizeInKilobytes(size);
+		}
+
 		void setMultiPV(int32_t count) {
 			_search.setMultiPV(count);
 		}
@@ -122,6 +137,7 @@ namespace QaplaSearch {
 			for (auto& window : _window) {
 				window.initSearch();
 			}	
+			_tt.getPawnTT()->clearStatistic();
 			_search.startNewSearch(searchBoard, searchMoves);
 			_clockManager.setNewMove();
 			if (_search.getComputingInfo().getMovesAmount() == 0) {
@@ -136,7 +152,7 @@ namespace QaplaSearch {
 			Move result;
 
 			// tt.readFromFile("C:\\Programming\\chess\\Qapla\\Qapla\\tt.bin");
-			moveHistory.setDrawPositionsToHash(position, _tt);
+			_gameKeys = moveHistory.getReversibleKeys(position);
 
 			static const uint8_t DEPTH_BUFFER = 0;
 			for (ply_t curDepth = 0; curDepth < maxDepth; curDepth++) {
@@ -151,8 +167,6 @@ namespace QaplaSearch {
 			}
 
 			// tt.writeToFile("tt.bin");
-			// Ensures that all draw positions are removed and not used after undo or new game
-			moveHistory.removeDrawPositionsFromHash(_tt);
 			//static int i = 0;
 			// tt.writeToFile("tt" + to_string(i) + ".bin"); i++;
 			return _search.getComputingInfo();
@@ -221,6 +235,7 @@ namespace QaplaSearch {
 		void searchOneIteration(MoveGenerator& position, uint32_t searchDepth)
 		{
 			SearchStack stack(&_tt);
+			stack.setGameKeys(_gameKeys);
 			bool isInWindow = false;
 			const auto multiPV = _search.getMultiPV();
 			for (uint32_t i = 0; i < multiPV; ++i) {
@@ -258,6 +273,8 @@ namespace QaplaSearch {
 		TT _tt;
 		Search _search;
 		array<AspirationWindow, MAX_PV> _window;
+		// Hash keys of the positions played before the root position
+		std::vector<hash_t> _gameKeys;
 		uint32_t ttDebug = 0;
 	};
 
@@ -0,0 +1,144 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ */
+
+#include <cstdlib>
+#include "keyhistory.h"
+
+using namespace QaplaSearch;
+
+std::array<hash_t, KeyHistory::CUCKOO_SIZE> KeyHistory::_cuckooKey;
+std::array<bitBoard_t, KeyHistory::CUCKOO_SIZE> KeyHistory::_cuckooBetween;
+std::array<Square, KeyHistory::CUCKOO_SIZE> KeyHistory::_cuckooFrom;
+std::array<Square, KeyHistory::CUCKOO_SIZE> KeyHistory::_cuckooTo;
+
+KeyHistory::InitStatics KeyHistory::_staticConstructor;
+
+KeyHistory::InitStatics::InitStatics() {
+	initCuckooTable();
+}
+
+/**
+ * Checks, if a piece is able to move from departure to destination on an empty board
+ */
+static bool isPieceMove(Piece pieceType, Square departure, Square destination) {
+	const int32_t fileDistance = std::abs(int32_t(getFile(destination)) - int32_t(getFile(departure)));
+	const int32_t rankDistance = std::abs(int32_t(getRank(destination)) - int32_t(getRank(departure)));
+	const bool isDiagonal = fileDistance == rankDistance;
+	const bool isStraight = fileDistance == 0 || rankDistance == 0;
+	switch (pieceType) {
+	case KNIGHT: return fileDistance * rankDistance == 2;
+	case BISHOP: return isDiagonal;
+	case ROOK: return isStraight;
+	case QUEEN: return isDiagonal || isStraight;
+	case KING: return std::max(fileDistance, rankDistance) == 1;
+	default: return false;
+	}
+}
+
+/**
+ * Computes the squares between departure and destination (excluding both) on a line or diagonal
+ */
+static bitBoard_t computeBetween(Square departure, Square destination) {
+	const int32_t fileStep = int32_t(getFile(destination)) - int32_t(getFile(departure));
+	const int32_t rankStep = int32_t(getRank(destination)) - int32_t(getRank(departure));
+	if (fileStep != 0 && rankStep != 0 && std::abs(fileStep) != std::abs(rankStep)) {
+		return 0;
+	}
+	const int32_t step = (fileStep > 0) - (fileStep < 0) + ((rankStep > 0) - (rankStep < 0)) * NORTH;
+	bitBoard_t result = 0;
+	for (Square square = departure + step; square != destination; square = square + step) {
+		result |= squareToBB(square);
+	}
+	return result;
+}
+
+void KeyHistory::initCuckooTable() {
+	_cuckooKey.fill(0);
+	_cuckooBetween.fill(0);
+	_cuckooFrom.fill(A1);
+	_cuckooTo.fill(A1);
+	const hash_t sideToMoveKey = HashConstants::COLOR_RANDOMS[0] ^ HashConstants::COLOR_RANDOMS[1];
+	[[maybe_unused]] uint32_t count = 0;
+	for (Piece piece = WHITE_KNIGHT; piece <= BLACK_KING; piece = Piece(piece + 1)) {
+		for (Square departure = A1; departure <= H8; ++departure) {
+			for (Square destination = departure + 1; destination <= H8; ++destination) {
+				if (!isPieceMove(getPieceType(piece), departure, destination)) {
+					continue;
+				}
+				hash_t key = HashConstants::cHashBoardRandoms[departure][piece]
+					^ HashConstants::cHashBoardRandoms[destination][piece] ^ sideToMoveKey;
+				bitBoard_t between = computeBetween(departure, destination);
+				Square from = departure;
+				Square to = destination;
+				uint32_t index = cuckooIndex1(key);
+				// Inserts the move and relocates the displaced entry to its alternative slot
+				while (true) {
+					std::swap(_cuckooKey[index], key);
+					std::swap(_cuckooBetween[index], between);
+					std::swap(_cuckooFrom[index], from);
+					std::swap(_cuckooTo[index], to);
+					if (key == 0) {
+						break;
+					}
+					index = index == cuckooIndex1(key) ? cuckooIndex2(key) : cuckooIndex1(key);
+				}
+				count++;
+			}
+		}
+	}
+	assert(count == 3668);
+}
+
+bool KeyHistory::hasUpcomingRepetition(const Board& position, ply_t ply, uint32_t reversiblePlies) const {
+	const uint32_t end = std::min({ reversiblePlies, uint32_t(_pliesFromNull[ply]), _gamePlies + uint32_t(ply) });
+	if (end < 3) {
+		return false;
+	}
+	const hash_t sideToMoveKey = HashConstants::COLOR_RANDOMS[0] ^ HashConstants::COLOR_RANDOMS[1];
+	const hash_t originalKey = getKey(ply, 0);
+	// Xor of all moves played since the compared position; zero, if they cancel out except one move
+	hash_t otherMoves = originalKey ^ getKey(ply, 1) ^ sideToMoveKey;
+	for (uint32_t distance = 3; distance <= end; distance += 2) {
+		otherMoves ^= getKey(ply, distance - 1) ^ getKey(ply, distance) ^ sideToMoveKey;
+		if (otherMoves != 0) {
+			continue;
+		}
+		const hash_t moveKey = originalKey ^ getKey(ply, distance);
+		uint32_t index = cuckooIndex1(moveKey);
+		if (_cuckooKey[index] != moveKey) {
+			index = cuckooIndex2(moveKey);
+			if (_cuckooKey[index] != moveKey) {
+				continue;
+			}
+		}
+		if ((_cuckooBetween[index] & position.getAllPiecesBB()) != 0) {
+			continue;
+		}
+		if (uint32_t(ply) > distance) {
+			return true;
+		}
+		// The repeated position is at or before the root: the move must be played by the side to move
+		const Square from = _cuckooFrom[index];
+		const Piece piece = position[from] != NO_PIECE ? position[from] : position[_cuckooTo[index]];
+		if (getPieceColor(piece) == (position.isWhiteToMove() ? WHITE : BLACK)) {
+			return true;
+		}
+	}
+	return false;
+}
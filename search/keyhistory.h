@@ -0,0 +1,140 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Hash key history of the game and the current search path in one ring buffer.
+ * Used to detect repetitions in the search tree and against positions played before
+ * the root. A cuckoo table of all reversible piece moves detects positions where
+ * the side to move is able to repeat a former position with a single move
+ * (algorithm by Marcel van Kervinck).
+ */
+
+#ifndef __KEYHISTORY_H
+#define __KEYHISTORY_H
+
+#include <array>
+#include <vector>
+#include <algorithm>
+#include "../basics/types.h"
+#include "../basics/hashconstants.h"
+#include "../basics/board.h"
+#include "searchparameter.h"
+
+using namespace QaplaBasics;
+
+namespace QaplaSearch {
+
+	class KeyHistory {
+	public:
+		KeyHistory() : _rootIndex(0), _gamePlies(0) {
+			_pliesFromNull.fill(0);
+		}
+
+		/**
+		 * Sets the keys of the positions played before the root, oldest first.
+		 * Only positions after the last pawn move or capture are relevant.
+		 */
+		void setGameKeys(const std::vector<hash_t>& gameKeys) {
+			const size_t first = gameKeys.size() > MAX_GAME_PLIES ? gameKeys.size() - MAX_GAME_PLIES : 0;
+			_gamePlies = uint32_t(gameKeys.size() - first);
+			for (size_t index = first; index < gameKeys.size(); index++) {
+				_keys[index & INDEX_MASK] = gameKeys[index];
+			}
+			_rootIndex = uint32_t(gameKeys.size());
+			_pliesFromNull[0] = uint16_t(_gamePlies);
+		}
+
+		/**
+		 * Sets the key of the position at ply
+		 * @param isAfterNullmove true, if the position has been reached by a nullmove
+		 */
+		inline void setKey(ply_t ply, hash_t key, bool isAfterNullmove) {
+			_keys[(_rootIndex + ply) & INDEX_MASK] = key;
+			if (ply > 0) {
+				_pliesFromNull[ply] = isAfterNullmove ? 0 : _pliesFromNull[ply - 1] + 1;
+			}
+		}
+
+		/**
+		 * Checks, if the position at ply repeats a position of the search path or of the game
+		 * @param reversiblePlies amount of plies without pawn move or capture
+		 */
+		inline bool isRepetition(ply_t ply, uint32_t reversiblePlies) const {
+			const uint32_t end = std::min(reversiblePlies, _gamePlies + uint32_t(ply));
+			const hash_t key = getKey(ply, 0);
+			for (uint32_t distance = 4; distance <= end; distance += 2) {
+				if (getKey(ply, distance) == key) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * Checks, if the side to move is able to repeat a position of the search path or of the game
+		 * with one reversible move.
+		 * @param reversiblePlies amount of plies without pawn move or capture
+		 */
+		bool hasUpcomingRepetition(const Board& position, ply_t ply, uint32_t reversiblePlies) const;
+
+		/**
+		 * Gets the key of the position distance plies before ply
+		 */
+		inline hash_t getKey(ply_t ply, uint32_t distance) const {
+			return _keys[(_rootIndex + ply - distance) & INDEX_MASK];
+		}
+
+	private:
+
+		/**
+		 * First and second hash function of the cuckoo table
+		 */
+		static inline uint32_t cuckooIndex1(hash_t key) { return uint32_t(key) & CUCKOO_MASK; }
+		static inline uint32_t cuckooIndex2(hash_t key) { return uint32_t(key >> 16) & CUCKOO_MASK; }
+
+		/**
+		 * Fills the cuckoo table with all reversible moves of knights, bishops, rooks, queens and kings
+		 */
+		static void initCuckooTable();
+
+		static const uint32_t SIZE = 1024;
+		static const uint32_t INDEX_MASK = SIZE - 1;
+		static const uint32_t MAX_GAME_PLIES = SIZE - SearchParameter::MAX_SEARCH_DEPTH - 1;
+		static const uint32_t CUCKOO_SIZE = 8192;
+		static const uint32_t CUCKOO_MASK = CUCKOO_SIZE - 1;
+
+		// Hash difference of two positions that differ by one reversible move
+		static std::array<hash_t, CUCKOO_SIZE> _cuckooKey;
+		// Squares between the departure and destination square of the move
+		static std::array<bitBoard_t, CUCKOO_SIZE> _cuckooBetween;
+		// Departure and destination square of the move
+		static std::array<Square, CUCKOO_SIZE> _cuckooFrom;
+		static std::array<Square, CUCKOO_SIZE> _cuckooTo;
+
+		alignas(64) std::array<hash_t, SIZE> _keys;
+		std::array<uint16_t, SearchParameter::MAX_SEARCH_DEPTH + 1> _pliesFromNull;
+		uint32_t _rootIndex;
+		uint32_t _gamePlies;
+
+		static struct InitStatics {
+			InitStatics();
+		} _staticConstructor;
+	};
+
+}
+
+#endif // __KEYHISTORY_H
@@ -0,0 +1,203 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Times single hot paths of the engine on a fixed set of positions
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <algorithm>
+#include "microbench.h"
+#include "see.h"
+#include "tt.h"
+#include "../eval/eval.h"
+#include "../bitbase/bitbase-reader.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define QAPLA_CYCLE_COUNTER
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define QAPLA_CYCLE_COUNTER
+#endif
+
+using namespace QaplaSearch;
+using namespace QaplaMoveGenerator;
+
+uint64_t MicroBench::readCycleCounter() {
+#ifdef QAPLA_CYCLE_COUNTER
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+void MicroBench::measure(std::ostream& os, const std::string& name, const std::function<uint64_t(uint64_t& checksum)>& pass) {
+	uint64_t checksum = 0;
+	for (uint32_t repetition = 0; repetition < settings.warmup; repetition++) {
+		pass(checksum);
+	}
+	double bestNanoseconds = 0;
+	double bestCycles = 0;
+	uint64_t calls = 0;
+	for (uint32_t repetition = 0; repetition < std::max(1U, settings.repetitions); repetition++) {
+		checksum = 0;
+		calls = 0;
+		const auto start = std::chrono::steady_clock::now();
+		const uint64_t startCycles = readCycleCounter();
+		for (uint32_t passNo = 0; passNo < settings.passes; passNo++) {
+			calls += pass(checksum);
+		}
+		const uint64_t cycles = readCycleCounter() - startCycles;
+		const auto nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		const double callCount = double(std::max<uint64_t>(1, calls));
+		if (repetition == 0 || nanoseconds / callCount < bestNanoseconds) {
+			bestNanoseconds = nanoseconds / callCount;
+			bestCycles = double(cycles) / callCount;
+		}
+	}
+	os << std::left << std::setw(18) << name << std::right
+		<< " calls: " << std::setw(10) << calls
+		<< " ns/call: " << std::setw(8) << std::fixed << std::setprecision(1) << bestNanoseconds
+		<< " cycles/call: " << std::setw(8) << bestCycles << std::defaultfloat
+		<< " checksum: " << static_cast<int64_t>(checksum) << std::endl;
+}
+
+void MicroBench::run(std::ostream& os) {
+	std::vector<MoveList> moveLists(positions.size());
+	for (size_t index = 0; index < positions.size(); index++) {
+		positions[index].genMovesOfMovingColor(moveLists[index]);
+	}
+	// Positions after every move of the corpus, thus probes see more than a few hash keys and signatures
+	std::vector<MoveGenerator> children;
+	for (size_t index = 0; index < positions.size(); index++) {
+		for (uint32_t moveNo = 0; moveNo < moveLists[index].getTotalMoveAmount(); moveNo++) {
+			children.push_back(positions[index]);
+			children.back().doMove(moveLists[index][moveNo]);
+		}
+	}
+	os << "Positions: " << positions.size() << " child positions: " << children.size()
+		<< " repetitions: " << settings.repetitions << " passes: " << settings.passes
+#ifndef QAPLA_CYCLE_COUNTER
+		<< " (no cycle counter on this platform)"
+#endif
+		<< std::endl;
+
+	measure(os, "genMoves", [&](uint64_t& checksum) {
+		for (auto& position : positions) {
+			MoveList moveList;
+			position.genMovesOfMovingColor(moveList);
+			checksum += moveList.getTotalMoveAmount();
+		}
+		return uint64_t(positions.size());
+	});
+
+	measure(os, "doMove/undoMove", [&](uint64_t& checksum) {
+		uint64_t calls = 0;
+		for (size_t index = 0; index < positions.size(); index++) {
+			auto& position = positions[index];
+			const auto& moveList = moveLists[index];
+			for (uint32_t moveNo = 0; moveNo < moveList.getTotalMoveAmount(); moveNo++) {
+				const BoardState boardState = position.getBoardState();
+				position.doMove(moveList[moveNo]);
+				checksum += position.computeBoardHash() & 0xFF;
+				position.undoMove(moveList[moveNo], boardState);
+			}
+			calls += moveList.getTotalMoveAmount();
+		}
+		return calls;
+	});
+
+	measure(os, "eval", [&](uint64_t& checksum) {
+		for (auto& position : children) {
+			checksum += uint64_t(ChessEval::Eval::eval(position));
+		}
+		return uint64_t(children.size());
+	});
+
+	measure(os, "SEE captures", [&](uint64_t& checksum) {
+		SEE see;
+		uint64_t calls = 0;
+		for (size_t index = 0; index < positions.size(); index++) {
+			const auto& moveList = moveLists[index];
+			for (uint32_t moveNo = 0; moveNo < moveList.getTotalMoveAmount(); moveNo++) {
+				if (!moveList[moveNo].isCapture()) continue;
+				checksum += uint64_t(see.computeSEEValueOfMove(positions[index], moveList[moveNo]));
+				calls++;
+			}
+		}
+		return calls;
+	});
+
+	std::vector<hash_t> hashKeys;
+	for (const auto& position : children) {
+		hashKeys.push_back(position.computeBoardHash());
+	}
+	TT tt;
+	tt.setSizeInKilobytes(16 * 1024);
+	measure(os, "TT setEntry", [&](uint64_t& checksum) {
+		for (const auto hashKey : hashKeys) {
+			checksum += tt.setEntry(hashKey, false, 5, 0, Move(), 0, value_t(hashKey & 0xFF), -MAX_VALUE, MAX_VALUE, 0) != TT::INVALID_INDEX;
+		}
+		return uint64_t(hashKeys.size());
+	});
+	measure(os, "TT getEntryIndex", [&](uint64_t& checksum) {
+		for (const auto hashKey : hashKeys) {
+			checksum += tt.getTTEntryIndex(hashKey) != TT::INVALID_INDEX;
+		}
+		return uint64_t(hashKeys.size());
+	});
+
+	measureBitbaseProbes(os);
+}
+
+void MicroBench::measureBitbaseProbes(std::ostream& os) {
+	using QaplaBitbase::BitbaseReader;
+	std::map<std::string, std::vector<MoveGenerator>> positionsByBitbase;
+	for (const auto& position : bitbasePositions) {
+		positionsByBitbase[PieceSignature(position.getPiecesSignature()).toString()].push_back(position);
+	}
+	for (const auto& [name, probePositions] : positionsByBitbase) {
+		// Non wins of white are only resolved with the bitbase of black, if black has mating material
+		PieceSignature signature(name.c_str());
+		std::vector<std::string> required{ name };
+		if (signature.hasEnoughMaterialToMate<BLACK>()) {
+			signature.changeSide();
+			required.push_back(signature.toString());
+		}
+		std::string missing;
+		for (const auto& bitbase : required) {
+			BitbaseReader::loadBitbase(bitbase, false);
+			if (!BitbaseReader::isBitbaseAvailable(bitbase)) {
+				missing += " " + bitbase;
+			}
+		}
+		const std::string benchName = "bitbase " + name;
+		if (!missing.empty()) {
+			os << std::left << std::setw(18) << benchName << std::right << " not loaded:" << missing << std::endl;
+			continue;
+		}
+		measure(os, benchName, [&](uint64_t& checksum) {
+			for (const auto& position : probePositions) {
+				checksum += uint64_t(BitbaseReader::getValueFromBitbase(position));
+			}
+			return uint64_t(probePositions.size());
+		});
+	}
+}
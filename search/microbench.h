@@ -0,0 +1,79 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Times single hot paths of the engine (move generation, do/undo move, eval, SEE,
+ * transposition table and bitbase probes) on fixed sets of positions. Every benchmark
+ * is run for some warmup repetitions first; the fastest of the timed repetitions is
+ * reported in nanoseconds and time stamp counter cycles per call.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <functional>
+#include "../movegenerator/movegenerator.h"
+
+namespace QaplaSearch {
+
+	class MicroBench {
+	public:
+		struct Settings {
+			uint32_t warmup = 2;
+			uint32_t repetitions = 5;
+			// Passes over all positions per repetition
+			uint32_t passes = 1000;
+		};
+
+		/**
+		 * @param positions positions for all benchmarks but the bitbase probes
+		 * @param bitbasePositions endgames with the stronger side as white, probed per bitbase
+		 */
+		MicroBench(const std::vector<QaplaMoveGenerator::MoveGenerator>& positions, 
+			const std::vector<QaplaMoveGenerator::MoveGenerator>& bitbasePositions, const Settings& settings)
+			: positions(positions), bitbasePositions(bitbasePositions), settings(settings) {}
+
+		/**
+		 * Runs all benchmarks and prints one line per benchmark
+		 */
+		void run(std::ostream& os);
+
+	private:
+		/**
+		 * Times a benchmark
+		 * @param pass Runs the benchmark once on all positions, adds a result summary to checksum
+		 *             and returns the number of calls
+		 */
+		void measure(std::ostream& os, const std::string& name, const std::function<uint64_t(uint64_t& checksum)>& pass);
+
+		/**
+		 * Loads the bitbases of the bitbase positions and times the probes per bitbase. 
+		 * Prints "not loaded" for a bitbase that is not available
+		 */
+		void measureBitbaseProbes(std::ostream& os);
+
+		static uint64_t readCycleCounter();
+
+		std::vector<QaplaMoveGenerator::MoveGenerator> positions;
+		std::vector<QaplaMoveGenerator::MoveGenerator> bitbasePositions;
+		Settings settings;
+	};
+
+}
@@ -25,7 +25,6 @@
 #include <vector>
 #include "../basics/move.h"
 #include "../movegenerator/movegenerator.h"
-#include "tt.h"
 
 using namespace std;
 using namespace QaplaBasics;
@@ -50,85 +49,62 @@ namespace QaplaSearch {
 		 */
 		void clearMoves() {
 			_history.resize(0);
-			_drawHashes.resize(0);
+			_snapshots.resize(0);
 		}
 
 		/**
 		 * Adds a move to the history
+		 * @param board position before the move is played
+		 * @param move move to play
 		 */
-		void addMove(Move move) {
+		void addMove(const MoveGenerator& board, Move move) {
+			_snapshots.push_back(board.getSnapshot());
 			_history.push_back(move);
 		}
 
 		/**
-		 * Undoes a move and returns the generated board
+		 * Undoes the last move by restoring the position stored before the move
 		 */
-		MoveGenerator undoMove() {
-			MoveGenerator board = startPosition;
-			_history.pop_back();
-			for (auto move : _history) {
-				board.doMove(move);
+		void undoMove(MoveGenerator& board) {
+			if (_history.empty()) {
+				return;
 			}
-			
-			return board;
+			board.setFromSnapshot(_snapshots.back());
+			_snapshots.pop_back();
+			_history.pop_back();
 		}
 
 		/**
 		 * Checks for draw by three-fold repetition
 		 */
 		bool isDrawByRepetition(const MoveGenerator& board) {
-
-			Board checkBoard = startPosition;
-			uint16_t moveNo = 0;
+			const PositionSnapshot current = board.getSnapshot();
 			uint8_t samePositionCount = 1;
-			while (moveNo + board.getHalfmovesWithoutPawnMoveOrCapture() < _history.size()) {
-				checkBoard.doMove(_history[moveNo]);
-				moveNo++;
-			}
-			for (; moveNo < _history.size(); moveNo++) {
-				if (checkBoard.isIdenticalPosition(board)) {
+			for (size_t moveNo = getFirstReversibleMoveNo(board); moveNo < _history.size(); moveNo++) {
+				if (_snapshots[moveNo].isIdenticalPosition(current)) {
 					samePositionCount++;
 				}
-				checkBoard.doMove(_history[moveNo]);
 			}
 			return samePositionCount >= 3;
-
-		}
-
-		/**
-		 * Sets all positions already played to hash to identify draw in the search
-		 */
-		void setDrawPositionsToHash(const MoveGenerator& board, TT& tt) {
-			value_t drawPositionValue = board.isWhiteToMove() ? -1 : 1;
-			computeDrawHashes(board);
-			auto iterator = _drawHashes.rbegin();
-			for (; iterator != _drawHashes.rend(); ++iterator) {
-				tt.setEntry(*iterator, true, TTEntry::MAX_DEPTH, 0,
-					Move::EMPTY_MOVE, drawPositionValue, drawPositionValue, -MAX_VALUE, MAX_VALUE, 0);
-				drawPositionValue = -drawPositionValue;
-			}
 		}
 
 		/**
-		 * Removes all positions formally set to draw from hash 
+		 * Gets the hash keys of all positions played after the last pawn move or capture,
+		 * oldest first, excluding the current position
 		 */
-		void removeDrawPositionsFromHash(TT& tt) {
-			for (auto drawHash : _drawHashes) {
-				uint32_t entryIndex = tt.getTTEntryIndex(drawHash);
-				if (entryIndex != TT::INVALID_INDEX) {
-					tt.getEntry(entryIndex).clear();
-				}
+		vector<hash_t> getReversibleKeys(const MoveGenerator& board) const {
+			vector<hash_t> keys;
+			for (size_t moveNo = getFirstReversibleMoveNo(board); moveNo < _history.size(); moveNo++) {
+				keys.push_back(_snapshots[moveNo].computeBoardHash());
 			}
+			return keys;
 		}
 
 		void print() {
-			std::cout << "Move history, history size " << _history.size() << " draw hashes size " << _drawHashes.size() << std::endl;
+			std::cout << "Move history, history size " << _history.size() << std::endl;
 			for (auto move : _history) {
 				cout << move.getLAN() << " ";
 			}
-			for (auto drawHash : _drawHashes) {
-				cout << drawHash << " ";
-			}
 			cout << startPosition.getFen() << endl;
 			cout << endl;
 		}
@@ -136,27 +112,16 @@ namespace QaplaSearch {
 	private:
 
 		/**
-		 * Computes the draw hashes out of the history
+		 * Gets the index of the first move played after the last pawn move or capture
 		 */
-		void computeDrawHashes(const MoveGenerator& board) {
-			_drawHashes.clear();
-			Board checkBoard = startPosition;
-			uint16_t moveNo = 0;
-			while (moveNo + board.getHalfmovesWithoutPawnMoveOrCapture() < _history.size()) {
-				checkBoard.doMove(_history[moveNo]);
-				moveNo++;
-			}
-			for (; ; moveNo++) {
-				_drawHashes.push_back(checkBoard.computeBoardHash());
-				if (moveNo == _history.size()) {
-					break;
-				}
-				checkBoard.doMove(_history[moveNo]);
-			}
+		size_t getFirstReversibleMoveNo(const MoveGenerator& board) const {
+			const size_t reversibleMoves = board.getHalfmovesWithoutPawnMoveOrCapture();
+			return _history.size() > reversibleMoves ? _history.size() - reversibleMoves : 0;
 		}
 
 		vector<Move> _history;
-		vector<hash_t> _drawHashes;
+		// Positions before each move of _history
+		vector<PositionSnapshot> _snapshots;
 		MoveGenerator startPosition;
 	};
 
@@ -113,11 +113,13 @@ namespace QaplaSearch {
 
 		/**
 		 * Initializes the move provider to provide all moves in a sorted order
+		 * COLOR must be the color to move
 		 */
+		template <Piece COLOR>
 		inline void computeMoves(MoveGenerator& board, ButterflyBoard& butterflyBoard, Move previousPlyMove, Move ttMove) {
 			_butterflyBoard = &butterflyBoard;
 			previousMove = previousPlyMove;
-			board.genMovesOfMovingColor(moveList);
+			board.genMovesOfColor<COLOR>(moveList);
 			selectStage = MoveType::PV;
 			curMoveNo = 0;
 			triedMovesAmount = 0;
@@ -127,12 +129,23 @@ namespace QaplaSearch {
 			_ttMove = ttMove;
 		}
 
+		inline void computeMoves(MoveGenerator& board, ButterflyBoard& butterflyBoard, Move previousPlyMove, Move ttMove) {
+			if (board.isWhiteToMove()) {
+				computeMoves<WHITE>(board, butterflyBoard, previousPlyMove, ttMove);
+			}
+			else {
+				computeMoves<BLACK>(board, butterflyBoard, previousPlyMove, ttMove);
+			}
+		}
+
 		/**
 		 * Initializes the move provider to provide captures
+		 * COLOR must be the color to move
 		 */
+		template <Piece COLOR>
 		inline void computeCaptures(MoveGenerator& board, Move previousPlyMove) {
 			previousMove = previousPlyMove;
-			board.genNonSilentMovesOfMovingColor(moveList);
+			board.genNonSilentMovesOfColor<COLOR>(moveList);
 			computeAllCaptureWeight(board);
 			curMoveNo = 0;
 			triedMovesAmount = 0;
@@ -140,10 +153,12 @@ namespace QaplaSearch {
 
 		/**
 		 * Initializes the move provider to provide evades
+		 * COLOR must be the color to move
 		 */
+		template <Piece COLOR>
 		inline void computeEvades(MoveGenerator& board, Move previousPlyMove) {
 			previousMove = previousPlyMove;
-			board.genEvadesOfMovingColor(moveList);
+			board.genEvadesOfColor<COLOR>(moveList);
 			curMoveNo = 0;
 			triedMovesAmount = 0;
 		}
@@ -207,7 +222,7 @@ namespace QaplaSearch {
 			}
 			if (selectedMoveNo != -1 && selectedMoveNo < (int32_t)moveList.getTotalMoveAmount()) {
 				move = moveList[(uint32_t)selectedMoveNo];
-				moveList[(uint32_t)selectedMoveNo].setEmpty();
+				moveList.setEmpty((uint32_t)selectedMoveNo);
 
 				assert(triedMovesAmount < TRIED_MOVES_STORE_SIZE);
 				triedMoves[triedMovesAmount] = move;
@@ -238,7 +253,7 @@ namespace QaplaSearch {
 
 			if (selectedMoveNo != -1) {
 				move = moveList[selectedMoveNo];
-				moveList[selectedMoveNo].setEmpty();
+				moveList.setEmpty(selectedMoveNo);
 			}
 
 			return move;
@@ -289,31 +304,20 @@ namespace QaplaSearch {
 		void computeAllCaptureWeight(const MoveGenerator& board) {
 			for (uint32_t moveNo = 0; moveNo < moveList.getNonSilentMoveAmount(); moveNo++) {
 				Move move = moveList[moveNo];
-				if (move != Move::EMPTY_MOVE) {
-					moveList.setWeight(moveNo, computeCaptureWeight(board, move));
-				}
+				moveList.setWeight(moveNo, move == Move::EMPTY_MOVE ? MoveList::EMPTY_WEIGHT : computeCaptureWeight(board, move));
 			}
 		}
 
 		/**
-		 * searches the next best capture move according his weight
+		 * searches the next best capture move according his weight. Empty moves and moves with
+		 * a weight of EMPTY_WEIGHT or below (loosing captures) are not selected
 		 */
 		int32_t findNextBestCaptureMove() {
-			int32_t bestMoveNo = -1;
-			value_t maxWeight = -MAX_VALUE;
-			value_t curWeight;
-			Move move;
-			for (uint32_t moveNo = curMoveNo; moveNo < moveList.getNonSilentMoveAmount(); moveNo++) {
-				move = moveList[moveNo];
-				if (move != Move::EMPTY_MOVE) {
-					curWeight = moveList.getWeight(moveNo);
-					if (curWeight > maxWeight) {
-						maxWeight = curWeight;
-						bestMoveNo = static_cast<int32_t>(moveNo);
-					}
-				}
+			const uint32_t bestMoveNo = moveList.findBestWeightIndex(curMoveNo, moveList.getNonSilentMoveAmount());
+			if (bestMoveNo >= moveList.getNonSilentMoveAmount() || moveList.getWeight(bestMoveNo) <= MoveList::EMPTY_WEIGHT) {
+				return -1;
 			}
-			return bestMoveNo;
+			return static_cast<int32_t>(bestMoveNo);
 		}
 
 		/**
@@ -42,7 +42,8 @@ void SplitPoint::addResult(uint64_t result) {
 }
 
 void PerftSearch::perftRecHelper(SplitPoint& splitPoint, WorkPackage &work, bool main) {
-	MoveGenerator board = splitPoint.getBoard();
+	MoveGenerator board;
+	board.setFromSnapshot(splitPoint.getSnapshot());
 	Move move;
 	uint64_t result = 0;
 	while(!(move = splitPoint.selectNextMove()).isEmpty()) {
@@ -65,10 +66,11 @@ uint64_t PerftSearch::perftRec(
 	MoveList moveList;
 	uint64_t result = 0;
 	if (curDepth == maxDepth) return 1;
-	board.genMovesOfMovingColor(moveList);
 	if (scipLastPly && curDepth + 1 == maxDepth) {
-		return moveList.getTotalMoveAmount();
+		// Bulk counting: the leaf moves are counted without materializing a move list
+		return board.countLegalMoves();
 	}
+	board.genMovesOfMovingColor(moveList);
 	bool isSplitPoint = curDepth >= 1 && curDepth < maxDepth - 4;
 	// bool isSplitPoint = curDepth == 1;
 	if (isSplitPoint) {
@@ -81,7 +81,7 @@ namespace QaplaSearch {
 
 		void set(const MoveList& moveList, const MoveGenerator& board, uint32_t maxDepth, uint32_t curDepth, bool scipLastPly) {
 			_moveList = moveList;
-			_board = board;
+			_snapshot = board.getSnapshot();
 			_maxDepth = maxDepth;
 			_curDepth = curDepth;
 			_scipLastPly = scipLastPly;
@@ -90,7 +90,7 @@ namespace QaplaSearch {
 			isActive = true;
 		}
 		void addResult(uint64_t result);
-		const MoveGenerator& getBoard() const { return _board; }
+		const PositionSnapshot& getSnapshot() const { return _snapshot; }
 		uint32_t getMaxDepth() const { return _maxDepth; }
 		uint32_t getCurDepth() const { return _curDepth; }
 		bool getScipLastPly() const { return _scipLastPly; }
@@ -99,7 +99,7 @@ namespace QaplaSearch {
 		Move selectNextMove();
 	private:
 		bool isActive;
-		MoveGenerator _board;
+		PositionSnapshot _snapshot;
 		MoveList _moveList;
 		uint32_t _index;
 		uint64_t _movesFound;
@@ -175,7 +175,13 @@ namespace QaplaSearch {
 
 		while (true) {
 			if (stack[curDepth].isMoveAvailable()) {
-				if (curDepth + 1 < depth) {
+				if (curDepth + 2 == depth && curDepth >= verbose) {
+					// Bulk counting of the last ply without generating the moves
+					stack[curDepth].doMove(board);
+					res += board.countLegalMoves();
+					stack[curDepth].undoMoveAndSetToNextMove(board);
+				}
+				else if (curDepth + 1 < depth) {
 					stack[curDepth].doMove(board);
 					curDepth++;
 					stack[curDepth].genMoves(board);
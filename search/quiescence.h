@@ -29,6 +29,7 @@
 #include "computinginfo.h"
 #include "../search/tt.h"
 #include "../movegenerator/movegenerator.h"
+#include "../eval/eval.h"
 #ifdef USE_STOCKFISH_EVAL
 #include "../nnue/engine.h"
 #endif
@@ -70,8 +71,19 @@ namespace QaplaSearch {
 		void setTT(TT* tt) { _tt = tt; }
 
 		/**
-	     * Performs the quiescense search
+		 * Gets the statistic of the staged stand pat evaluation
+		 */
+		const ChessEval::EvalStageStatistic& getEvalStatistic() const { return _evalStatistic; }
+
+		/**
+		 * Clears the statistic of the staged stand pat evaluation
+		 */
+		void clearEvalStatistic() { _evalStatistic.clear(); }
+
+		/**
+	     * Performs the quiescense search, COLOR is the color to move
 	     */
+		template <Piece COLOR>
 		value_t search(
 			bool isPvNode,
 			MoveGenerator& board, ComputingInfo& computingInfo, Move lastMove,
@@ -96,6 +108,9 @@ namespace QaplaSearch {
 
 		TT* _tt;
 
+	private:
+		ChessEval::EvalStageStatistic _evalStatistic;
+
 	};
 
 }
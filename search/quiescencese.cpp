@@ -71,12 +71,13 @@ std::tuple<value_t, value_t, uint32_t, Move> Quiescence::probeTT(MoveGenerator&
 /**
  * Performs the quiescense search
  */
+template <Piece COLOR>
 value_t Quiescence::search(bool isPvNode,
 	MoveGenerator& position, ComputingInfo& computingInfo, Move lastMove,
 	value_t alpha, value_t beta, ply_t ply)
 {
 	if (ply >= SearchParameter::MAX_SEARCH_DEPTH) {
-		return position.isInCheck() ? DRAW_VALUE : Eval::eval(position, _tt->getPawnTT(), ply);
+		return position.isInCheck<COLOR>() ? DRAW_VALUE : Eval::eval(position, _tt->getPawnTT(), ply);
 	}
 	if (alpha > MAX_VALUE - ply) {
 		return MAX_VALUE - ply;
@@ -96,13 +97,13 @@ value_t Quiescence::search(bool isPvNode,
 	moveProvider.setTTMove(ttMove);
 	if (/*alpha + 1 == beta && */ ttValue != NO_VALUE) return ttValue;
 
-	const auto evadesCheck = SearchParameter::EVADES_CHECK_IN_QUIESCENSE && position.isInCheck();
+	const auto evadesCheck = SearchParameter::EVADES_CHECK_IN_QUIESCENSE && position.isInCheck<COLOR>();
 	value_t bestValue, standPatValue;
 	if (evadesCheck) {
 		bestValue = standPatValue = -MAX_VALUE + ply;
 	}
 	else {
-		bestValue = standPatValue = ttEval != NO_VALUE ? ttEval : Eval::eval(position, _tt->getPawnTT(), ply, alpha);
+		bestValue = standPatValue = ttEval != NO_VALUE ? ttEval : Eval::evalInWindow(position, _tt->getPawnTT(), ply, alpha, beta, _evalStatistic);
 		if (std::abs(ttValue) < MIN_MATE_VALUE && (ttPrecision == TTEntry::EXACT || 
 			(ttPrecision == (standPatValue < ttValue ? TTEntry::GREATER_OR_EQUAL : TTEntry::LESSER_OR_EQUAL))))
 		{
@@ -117,9 +118,9 @@ value_t Quiescence::search(bool isPvNode,
 			alpha = standPatValue;
 		}
 		if (evadesCheck) {
-			moveProvider.computeEvades(position, lastMove);
+			moveProvider.computeEvades<COLOR>(position, lastMove);
 		} else {
-			moveProvider.computeCaptures(position, lastMove);
+			moveProvider.computeCaptures<COLOR>(position, lastMove);
 		}
 		while (!(move = moveProvider.selectNextCaptureOrEvade(position, evadesCheck)).isEmpty()) {
 			valueOfNextPlySearch = computePruneForewardValue(position, standPatValue, move);
@@ -129,7 +130,7 @@ value_t Quiescence::search(bool isPvNode,
 				}
 				break;
 			}
-			if (SearchParameter::QUIESCENSE_USE_SEE_PRUNINT && SEE::isLoosingCaptureLight(position, move)) {
+			if (SearchParameter::QUIESCENSE_USE_SEE_PRUNINT && SEE::isLoosingCaptureLight<COLOR>(position, move)) {
 				continue;
 			}
 
@@ -138,7 +139,7 @@ value_t Quiescence::search(bool isPvNode,
 #ifdef USE_STOCKFISH_EVAL
 			Stockfish::Engine::doMove(move, si);
 #endif
-			valueOfNextPlySearch = -search(isPvNode, position, computingInfo, move, -beta, -alpha, ply + 1);
+			valueOfNextPlySearch = -search<opponentColor<COLOR>()>(isPvNode, position, computingInfo, move, -beta, -alpha, ply + 1);
 			position.undoMove(move, positionState);
 #ifdef USE_STOCKFISH_EVAL
 			Stockfish::Engine::undoMove(move);
@@ -161,3 +162,8 @@ value_t Quiescence::search(bool isPvNode,
 }
 
 
+
+template value_t Quiescence::search<WHITE>(bool isPvNode, MoveGenerator& position, ComputingInfo& computingInfo, 
+	Move lastMove, value_t alpha, value_t beta, ply_t ply);
+template value_t Quiescence::search<BLACK>(bool isPvNode, MoveGenerator& position, ComputingInfo& computingInfo, 
+	Move lastMove, value_t alpha, value_t beta, ply_t ply);
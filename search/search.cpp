@@ -53,6 +53,7 @@ bool Search::hasBitbaseCutoff(const MoveGenerator& position, SearchVariables& no
 /**
  * Check, if it is reasonable to do a nullmove search
  */
+template <Piece COLOR>
 bool Search::isNullmoveReasonable(MoveGenerator& position, SearchVariables& node, ply_t depth, ply_t ply) {
 	bool result = true;
 	if (!SearchParameter::DO_NULLMOVE) {
@@ -66,7 +67,7 @@ bool Search::isNullmoveReasonable(MoveGenerator& position, SearchVariables& node
 	else if (node.adjustedEval < node.beta) {
 		return false;
 	} 
-	else if (position.getMaterialValue(position.isWhiteToMove()).midgame() + MaterialBalance::PAWN_VALUE_MG < node.beta) {
+	else if (position.getMaterialValue(COLOR == WHITE).midgame() + MaterialBalance::PAWN_VALUE_MG < node.beta) {
 		result = false;
 	}
 	else if (node.remainingDepth <= SearchParameter::NULLMOVE_REMAINING_DEPTH) {
@@ -75,10 +76,10 @@ bool Search::isNullmoveReasonable(MoveGenerator& position, SearchVariables& node
 	else if (node.noNullmove) {
 		result = false;
 	}
-	else if (!position.sideToMoveHasQueenRookBishop(position.isWhiteToMove())) {
+	else if (!position.sideToMoveHasQueenRookBishop(COLOR == WHITE)) {
 		result = false;
 	}
-	else if (position.isInCheck()) {
+	else if (position.isInCheck<COLOR>()) {
 		result = false;
 	}
 	else if (node.beta >= MAX_VALUE - value_t(ply)) {
@@ -104,21 +105,23 @@ bool Search::isNullmoveReasonable(MoveGenerator& position, SearchVariables& node
 /**
  * Check for a nullmove cutoff
  */
+template <Piece COLOR>
 bool Search::isNullmoveCutoff(MoveGenerator& position, SearchStack& stack, ply_t depth, ply_t ply)
 {
+	constexpr Piece OPPONENT = opponentColor<COLOR>();
 	SearchVariables& node = stack[ply];
-	if (!isNullmoveReasonable(position, node, depth, ply)) {
+	if (!isNullmoveReasonable<COLOR>(position, node, depth, ply)) {
 		return false;
 	}
-	assert(!position.isInCheck());
+	assert(!position.isInCheck<COLOR>());
 	SearchVariables& childNode = stack[ply + 1];
 
 	ply_t R = SearchParameter::getNullmoveReduction(ply, depth, node.betaAtPlyStart, node.adjustedEval);
 
-	childNode.doMove(position, Move::NULL_MOVE);
+	childNode.doMove<COLOR>(position, Move::NULL_MOVE);
 	node.bestValue = depth - R > 2 ?
-		-negaMax<SearchRegion::INNER>(position, stack, -node.beta, -node.beta + 1, depth - R - 1, ply + 1) :
-		-negaMax<SearchRegion::NEAR_LEAF>(position, stack, -node.beta, -node.beta + 1, depth - R - 1, ply + 1);
+		-negaMax<SearchRegion::INNER, OPPONENT>(position, stack, -node.beta, -node.beta + 1, depth - R - 1, ply + 1) :
+		-negaMax<SearchRegion::NEAR_LEAF, OPPONENT>(position, stack, -node.beta, -node.beta + 1, depth - R - 1, ply + 1);
 
 	WhatIf::whatIf.moveSearched(position, _computingInfo, stack, Move::NULL_MOVE, depth - R - 1, ply, node.bestValue, "null");
 	childNode.undoMove(position);
@@ -127,7 +130,7 @@ bool Search::isNullmoveCutoff(MoveGenerator& position, SearchStack& stack, ply_t
 	if (isCutoff && depth - R - 1 >= 0) {
 		position.computeAttackMasksForBothColors();
 		node.isVerifyingNullmove = true;
-		const auto verify = negaMaxPreSearch(position, stack, node.alpha, node.beta, depth - R - 1, ply);
+		const auto verify = negaMaxPreSearch<COLOR>(position, stack, node.alpha, node.beta, depth - R - 1, ply);
 		node.isVerifyingNullmove = false;
 		isCutoff = verify >= node.beta;
 	}
@@ -158,18 +161,20 @@ ply_t Search::computeLMR(SearchVariables& node, MoveGenerator& position, ply_t d
 	return lmr;
 }
 
+template <Piece COLOR>
 value_t Search::negaMaxPreSearch(MoveGenerator& position, SearchStack& stack, value_t alpha, value_t beta, ply_t depth, ply_t ply) {
+	constexpr Piece OPPONENT = opponentColor<COLOR>();
 	SearchVariables& node = stack[ply];
 	SearchVariables& childNode = stack[ply + 1];
 	node.setFromParentNode(position, stack[ply - 1], alpha, beta, depth, false);
 	// Must be after setFromParentNode
 	node.probeTT(false, alpha, beta, depth, ply);
-	node.computeMoves(position, _butterflyBoard);
+	node.computeMoves<COLOR>(position, _butterflyBoard);
 	Move curMove;
 	while (!(curMove = node.selectNextMove(position)).isEmpty()) {
 
-		childNode.doMove(position, curMove);
-		const auto result = -negaMax<SearchRegion::INNER>(position, stack, -node.alpha - 1, -node.alpha, depth - 1, ply + 1);
+		childNode.doMove<COLOR>(position, curMove);
+		const auto result = -negaMax<SearchRegion::INNER, OPPONENT>(position, stack, -node.alpha - 1, -node.alpha, depth - 1, ply + 1);
 		node.setSearchResult(result, childNode, curMove);
 		WhatIf::whatIf.moveSearched(position, _computingInfo, stack, curMove, depth - 1, ply, result, "PRE");
 		childNode.undoMove(position);
@@ -186,6 +191,7 @@ value_t Search::negaMaxPreSearch(MoveGenerator& position, SearchStack& stack, va
  * IID modifies variables from stack[ply] (like move counter, search depth, ...)
  * Thus it must be called before setting the stack in negamax (setFromPreviousPly).
  */
+template <Piece COLOR>
 void Search::iid(MoveGenerator& position, SearchStack& stack, value_t alpha, value_t beta, ply_t depth, ply_t ply) {
 	SearchVariables& node = stack[ply];
 
@@ -194,7 +200,7 @@ void Search::iid(MoveGenerator& position, SearchStack& stack, value_t alpha, val
 	if (!node.getTTMove().isEmpty()) return;
 
 	ply_t iidR = SearchParameter::getIIDReduction(depth);
-	const value_t curValue = negaMax<SearchRegion::PV>(position, stack, alpha, beta, depth - iidR, ply);
+	const value_t curValue = negaMax<SearchRegion::PV, COLOR>(position, stack, alpha, beta, depth - iidR, ply);
 	WhatIf::whatIf.moveSearched(position, _computingInfo, stack, stack[ply].previousMove, depth - iidR, ply - 1, curValue, "IID");
 	position.computeAttackMasksForBothColors();
 	if (!node.bestMove.isEmpty()) {
@@ -203,7 +209,9 @@ void Search::iid(MoveGenerator& position, SearchStack& stack, value_t alpha, val
 
 }
 
+template <Piece COLOR>
 ply_t Search::se(MoveGenerator& position, SearchStack& stack, value_t alpha, value_t beta, ply_t depth, ply_t ply) {
+	constexpr Piece OPPONENT = opponentColor<COLOR>();
 	if (!SearchParameter::DO_SE_EXTENSION) return 0;
 	SearchVariables& node = stack[ply];
 	SearchVariables& childNode = stack[ply + 1];
@@ -242,15 +250,15 @@ ply_t Search::se(MoveGenerator& position, SearchStack& stack, value_t alpha, val
 	_computingInfo._nodesSearched++;
 
 	// Cutoffs checks all kind of cutoffs including futility, nullmove, bitbase and others 
-	if (checkCutoffAndSetEval<SearchRegion::NEAR_LEAF>(position, stack, node, seDepth, ply)) return 0;
+	if (checkCutoffAndSetEval<SearchRegion::NEAR_LEAF, COLOR>(position, stack, node, seDepth, ply)) return 0;
 
-	node.computeMoves(position, _butterflyBoard);
+	node.computeMoves<COLOR>(position, _butterflyBoard);
 	Move curMove;
 	while (!(curMove = node.selectNextMove(position)).isEmpty()) {
 		if (curMove == ttMove) continue;
 
-		childNode.doMove(position, curMove);
-		const auto result = -negaMax<SearchRegion::INNER>(position, stack, -node.alpha - 1, -node.alpha, seDepth - 1, ply + 1);
+		childNode.doMove<COLOR>(position, curMove);
+		const auto result = -negaMax<SearchRegion::INNER, OPPONENT>(position, stack, -node.alpha - 1, -node.alpha, seDepth - 1, ply + 1);
 		node.setSearchResult(result, childNode, curMove);
 		WhatIf::whatIf.moveSearched(position, _computingInfo, stack, curMove, seDepth - 1, ply, result, "SE");
 		childNode.undoMove(position);
@@ -272,7 +280,7 @@ bool Search::nonSearchingCutoff(MoveGenerator& position, SearchStack& stack, Sea
 	assert(ply >= 1);
 
 	node.cutoff = Cutoff::NONE;
-	node.setHashSignature(position);
+	stack.setHashSignature(position, ply);
 
 	if (TYPE != SearchRegion::PV && alpha > MAX_VALUE - value_t(ply)) {
 		node.setCutoff(Cutoff::FASTER_MATE_FOUND, MAX_VALUE - value_t(ply));
@@ -286,6 +294,10 @@ bool Search::nonSearchingCutoff(MoveGenerator& position, SearchStack& stack, Sea
 	else if (stack.isDrawByRepetitionInSearchTree(position, ply)) {
 		node.setCutoff(Cutoff::DRAW_BY_REPETITION, 0);
 	}
+	// The side to move is able to force a draw by repetition, thus the value is at least a draw
+	else if (TYPE != SearchRegion::PV && beta <= 0 && stack.hasUpcomingRepetition(position, ply)) {
+		node.setCutoff(Cutoff::DRAW_BY_REPETITION, 0);
+	}
 	else if (position.getTotalHalfmovesWithoutPawnMoveOrCapture() >= 100) {
 		node.setCutoff(Cutoff::DRAW_BY_50_MOVES_RULE, 0);
 	}
@@ -309,8 +321,9 @@ bool Search::nonSearchingCutoff(MoveGenerator& position, SearchStack& stack, Sea
 /**
  * Negamax algorithm for plys 1..n
  */
-template <Search::SearchRegion TYPE>
+template <Search::SearchRegion TYPE, Piece COLOR>
 value_t Search::negaMax(MoveGenerator& position, SearchStack& stack, value_t alpha, value_t beta, ply_t depth, ply_t ply) {
+	constexpr Piece OPPONENT = opponentColor<COLOR>();
 
 	SearchVariables& node = stack[ply];
 	node.pvMovesStore.setEmpty(ply);
@@ -323,7 +336,7 @@ value_t Search::negaMax(MoveGenerator& position, SearchStack& stack, value_t alp
 
 	// 2. Quiescense search
 	if (depth < 0) {
-		return _quiescence.search(TYPE == SearchRegion::PV, position, _computingInfo, node.previousMove, alpha, beta, ply);
+		return _quiescence.search<COLOR>(TYPE == SearchRegion::PV, position, _computingInfo, node.previousMove, alpha, beta, ply);
 	}
 
 	const auto nodesSearched = _computingInfo._nodesSearched;
@@ -346,10 +359,10 @@ value_t Search::negaMax(MoveGenerator& position, SearchStack& stack, value_t alp
 	WhatIf::whatIf.moveSelected(position, _computingInfo, stack, node.previousMove, depth, ply);
 
 	// 4. IID recursive for pv move. Must be before node.setFromParentNode, as it modifies node values
-	if (TYPE == SearchRegion::PV) iid(position, stack, alpha, beta, depth, ply);
+	if (TYPE == SearchRegion::PV) iid<COLOR>(position, stack, alpha, beta, depth, ply);
 
 	// 5. Singular extension
-	const auto seExtension = se(position, stack, alpha, beta, depth, ply);
+	const auto seExtension = se<COLOR>(position, stack, alpha, beta, depth, ply);
 
 	value_t result;
 	Move curMove;
@@ -361,12 +374,12 @@ value_t Search::negaMax(MoveGenerator& position, SearchStack& stack, value_t alp
 
 	// 7. Check all kind of early cutoffs including futility, nullmove, bitbase and others 
 	// Additionally set eval. This is done as late as possible, as it is very time consuming. Some cutoff checks needs eval.
-	if (checkCutoffAndSetEval<TYPE>(position, stack, node, depth, ply)) {
+	if (checkCutoffAndSetEval<TYPE, COLOR>(position, stack, node, depth, ply)) {
 		WhatIf::whatIf.cutoff(position, _computingInfo, stack, ply, node.cutoff);
 		return node.bestValue;
 	}
 
-	node.computeMoves(position, _butterflyBoard);
+	node.computeMoves<COLOR>(position, _butterflyBoard);
 	// 8. Calculate additional search extensions
 	if (TYPE == SearchRegion::PV) depth = node.extendSearch(position, stack[0].remainingDepth, seExtension);
 
@@ -379,14 +392,14 @@ value_t Search::negaMax(MoveGenerator& position, SearchStack& stack, value_t alp
 		// 1. Move count pruning
 		if (lmr > 0 && depth - lmr < 0 && node.bestValue > -MIN_MATE_VALUE && position.hasMoreThanPawns()) continue;
 
-		childNode.doMove(position, curMove);
+		childNode.doMove<COLOR>(position, curMove);
 
 		// 2. Late move reduction search
 		// We continue with the next move, if the lmr search returns a value less than alpha
 		if (lmr > 0) {
 			result = TYPE != SearchRegion::NEAR_LEAF && depth - lmr > 2 ?
-				-negaMax<SearchRegion::INNER>(position, stack, -node.alpha - 1, -node.alpha, depth - 1 - lmr, ply + 1) :
-				-negaMax<SearchRegion::NEAR_LEAF>(position, stack, -node.alpha - 1, -node.alpha, depth - 1 - lmr, ply + 1);
+				-negaMax<SearchRegion::INNER, OPPONENT>(position, stack, -node.alpha - 1, -node.alpha, depth - 1 - lmr, ply + 1) :
+				-negaMax<SearchRegion::NEAR_LEAF, OPPONENT>(position, stack, -node.alpha - 1, -node.alpha, depth - 1 - lmr, ply + 1);
 			WhatIf::whatIf.moveSearched(position, _computingInfo, stack, curMove, depth - 1 - lmr, ply, result, "LMR");
 			if (result <= node.alpha) {
 				childNode.undoMove(position);
@@ -405,8 +418,8 @@ value_t Search::negaMax(MoveGenerator& position, SearchStack& stack, value_t alp
 		bool isDirectPVWindowSearch = TYPE == SearchRegion::PV && (node.moveNumber == 1 || depth <= 1);
 		if (!isDirectPVWindowSearch) {
 			result = TYPE != SearchRegion::NEAR_LEAF && depth > 2 ?
-				-negaMax<SearchRegion::INNER>(position, stack, -node.alpha - 1, -node.alpha, depth - 1, ply + 1) :
-				-negaMax<SearchRegion::NEAR_LEAF>(position, stack, -node.alpha - 1, -node.alpha, depth - 1, ply + 1);
+				-negaMax<SearchRegion::INNER, OPPONENT>(position, stack, -node.alpha - 1, -node.alpha, depth - 1, ply + 1) :
+				-negaMax<SearchRegion::NEAR_LEAF, OPPONENT>(position, stack, -node.alpha - 1, -node.alpha, depth - 1, ply + 1);
 			WhatIf::whatIf.moveSearched(position, _computingInfo, stack, curMove, depth - 1, ply, result, TYPE == SearchRegion::PV ? "ZeroW" : "Std.");
 		}
 		// 4. Full window PV search or research the move with full window, if result is better than alpha
@@ -415,7 +428,7 @@ value_t Search::negaMax(MoveGenerator& position, SearchStack& stack, value_t alp
 			if (!isDirectPVWindowSearch) {
 				position.computeAttackMasksForBothColors();
 			}
-			result = -negaMax<SearchRegion::PV>(position, stack, -node.beta, -node.alpha, adjustedDepth - 1, ply + 1);
+			result = -negaMax<SearchRegion::PV, OPPONENT>(position, stack, -node.beta, -node.alpha, adjustedDepth - 1, ply + 1);
 			WhatIf::whatIf.moveSearched(position, _computingInfo, stack, curMove, adjustedDepth - 1, ply, result, "PV");
 		}
 
@@ -443,13 +456,27 @@ void Search::negaMaxRoot(MoveGenerator& position, SearchStack& stack, uint32_t s
 	_quiescence.setTT(stack[0].getTT());
 	_clockManager = &clockManager;
 	position.computeAttackMasksForBothColors();
+	if (position.isWhiteToMove()) {
+		negaMaxRoot<WHITE>(position, stack, skipMoves);
+	}
+	else {
+		negaMaxRoot<BLACK>(position, stack, skipMoves);
+	}
+}
+
+/**
+ * Negamax algorithm for the first ply with the color to move known at compile time
+ */
+template <Piece COLOR>
+void Search::negaMaxRoot(MoveGenerator& position, SearchStack& stack, uint32_t skipMoves) {
+	constexpr Piece OPPONENT = opponentColor<COLOR>();
 	SearchVariables& node = stack[0];
 	value_t result;
 
 	ply_t depth = node.remainingDepth;
 
 	// we use the movelist from rootmoves. node.computeMoves is only to initialize other variables
-	node.computeMoves(position, _butterflyBoard);
+	node.computeMoves<COLOR>(position, _butterflyBoard);
 	_computingInfo.nextIteration(node);
 	WhatIf::whatIf.moveSelected(position, _computingInfo, stack, Move::EMPTY_MOVE, depth, 0);
 #ifdef USE_STOCKFISH_EVAL
@@ -466,11 +493,11 @@ void Search::negaMaxRoot(MoveGenerator& position, SearchStack& stack, uint32_t s
 		const Move curMove = rootMove.getMove();
 		_computingInfo.setCurrentMove(triedMoves, curMove);
 
-		stack[1].doMove(position, curMove);
+		stack[1].doMove<COLOR>(position, curMove);
 		auto pvSearch = depth <= 1 || triedMoves <= skipMoves;
 		result = pvSearch ?
-			-negaMax<SearchRegion::PV>(position, stack, -node.beta, -node.alpha, depth - 1, 1):
-			-negaMax<SearchRegion::INNER>(position, stack, -node.alpha - 1, -node.alpha, depth - 1, 1);
+			-negaMax<SearchRegion::PV, OPPONENT>(position, stack, -node.beta, -node.alpha, depth - 1, 1):
+			-negaMax<SearchRegion::INNER, OPPONENT>(position, stack, -node.alpha - 1, -node.alpha, depth - 1, 1);
 		stack[1].undoMove(position);
 
 		// AbortSearch must be checked first. If it is true, we do not have a valid search result
@@ -480,8 +507,8 @@ void Search::negaMaxRoot(MoveGenerator& position, SearchStack& stack, uint32_t s
 			WhatIf::whatIf.moveSearched(position, _computingInfo, stack, curMove, depth - 1, 0, result);
 			pvSearch = true;
 			node.setPVWindow();
-			stack[1].doMove(position, curMove);
-			result = -negaMax<SearchRegion::PV>(position, stack, -node.beta, -node.alpha, depth - 1, 1);
+			stack[1].doMove<COLOR>(position, curMove);
+			result = -negaMax<SearchRegion::PV, OPPONENT>(position, stack, -node.beta, -node.alpha, depth - 1, 1);
 			stack[1].undoMove(position);
 		}
 
@@ -509,6 +536,10 @@ void Search::negaMaxRoot(MoveGenerator& position, SearchStack& stack, uint32_t s
 	if (!_clockManager->isSearchStopped()) node.updateTTandKiller(position, _butterflyBoard, true, depth);
 	_computingInfo.getRootMoves().bubbleSort(0);
 	_computingInfo.setHashFullInPermill(node.getHashFillRateInPermill());
+	const auto pawnTT = node.getTT()->getPawnTT();
+	_computingInfo.setPawnHashStatistic(pawnTT->getProbes(), pawnTT->getHits());
+	const auto& evalStatistic = _quiescence.getEvalStatistic();
+	_computingInfo.setEvalStageStatistic(evalStatistic.materialStageExits, evalStatistic.fullEvals);
 	_computingInfo.printSearchResult();
 }
 
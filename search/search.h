@@ -67,6 +67,7 @@ namespace QaplaSearch {
 		void startNewSearch(MoveGenerator& position, const std::vector<Move>& searchMoves) {
 			_computingInfo.initNewSearch(position, searchMoves, _butterflyBoard);
 			_butterflyBoard.newSearch();
+			_quiescence.clearEvalStatistic();
 		}
 
 		/**
@@ -117,10 +118,10 @@ namespace QaplaSearch {
 		/**
 		 * Check for cutoffs
 		 */
-		template <SearchRegion TYPE>
+		template <SearchRegion TYPE, Piece COLOR>
 		bool checkCutoffAndSetEval(MoveGenerator& position, SearchStack& stack, SearchVariables& node, ply_t depth, ply_t ply) {
 			const auto evalBefore = ply > 1 ? stack[ply - 2].adjustedEval : NO_VALUE;
-			if (position.isInCheck()) {
+			if (position.isInCheck<COLOR>()) {
 				node.adjustedEval = evalBefore;
 				return false;
 			}
@@ -136,7 +137,7 @@ namespace QaplaSearch {
 				node.setCutoff(Cutoff::FUTILITY);
 				return true;
 			} 
-			if (TYPE == SearchRegion::INNER && isNullmoveCutoff(position, stack, depth, ply)) {
+			if (TYPE == SearchRegion::INNER && isNullmoveCutoff<COLOR>(position, stack, depth, ply)) {
 				node.setCutoff(Cutoff::NULL_MOVE);
 				return true;
 			}
@@ -144,8 +145,10 @@ namespace QaplaSearch {
 		}
 
 
+		template <Piece COLOR>
 		void iid(MoveGenerator& position, SearchStack& stack, value_t alpha, value_t beta, ply_t depth, ply_t ply);
 
+		template <Piece COLOR>
 		ply_t se(MoveGenerator& position, SearchStack& stack, value_t alpha, value_t beta, ply_t depth, ply_t ply);
 
 		ply_t computeLMR(SearchVariables& node, MoveGenerator& position, ply_t depth, ply_t ply, Move move);
@@ -153,21 +156,31 @@ namespace QaplaSearch {
 		/**
 		 * Check, if it is reasonable to do a nullmove search
 		 */
+		template <Piece COLOR>
 		bool isNullmoveReasonable(MoveGenerator& position, SearchVariables& node, ply_t depth, ply_t ply);
 
 		/**
 		 * Check for a nullmove cutoff
 		 */
+		template <Piece COLOR>
 		bool isNullmoveCutoff(MoveGenerator& position, SearchStack& stack, ply_t depth, ply_t ply);
 
 		/**
 		 * Do a full search using the negaMax algorithm
+		 * The color to move is a template parameter to avoid branching on the side to move
 		 */
-		template <SearchRegion TYPE>
+		template <SearchRegion TYPE, Piece COLOR>
 		value_t negaMax(MoveGenerator& position, SearchStack& stack, value_t alpha, value_t beta, ply_t depth, ply_t ply);
 
+		template <Piece COLOR>
 		value_t negaMaxPreSearch(MoveGenerator& position, SearchStack& stack, value_t alpha, value_t beta, ply_t depth, ply_t ply);
 
+		/**
+		 * Negamax algorithm for the first ply with the color to move known at compile time
+		 */
+		template <Piece COLOR>
+		void negaMaxRoot(MoveGenerator& position, SearchStack& stack, uint32_t skipMoves);
+
 		/**
 		 * Returns the information about the root moves
 		 */
@@ -23,6 +23,7 @@
 #define __SEARCHSTACK_H
 
 #include "searchvariables.h"
+#include "keyhistory.h"
 #include "tt.h"
 // #include "HistoryTable.h"
 
@@ -58,6 +59,14 @@ namespace QaplaSearch {
 
 		void initSearchAtRoot(MoveGenerator& board, value_t alpha, value_t beta, int32_t searchDepth) {
 			_stack[0].initSearchAtRoot(board, alpha, beta, searchDepth);
+			_keyHistory.setKey(0, _stack[0].positionHashSignature, false);
+		}
+
+		/**
+		 * Sets the keys of the positions played in the game before the root position
+		 */
+		void setGameKeys(const std::vector<hash_t>& gameKeys) {
+			_keyHistory.setGameKeys(gameKeys);
 		}
 
 		Move getMoveFromPVMovesStore(SearchVariables::pvIndex_t ply) {
@@ -94,24 +103,31 @@ namespace QaplaSearch {
 			for (ply_t index = 0; index <= ply; index++) {
 				searchVariablePtr[index] = foreignStack.searchVariablePtr[index];
 			}
+			_keyHistory = foreignStack._keyHistory;
 			copyKillers(foreignStack, ply + 1);
 		}
 
 		/**
-		 * Check, if there is a two fold repetition in the search tree.
+		 * Sets the hash signature of the position at ply and stores it in the key history
 		 */
-		bool isDrawByRepetitionInSearchTree(const Board& board, ply_t ply) {
-			bool drawByRepetition = false;
-			ply_t checkPly = ply - 4;
-			ply_t minPly = ply - board.getHalfmovesWithoutPawnMoveOrCapture();
-			if (minPly < 0) { minPly = 0; }
-			for (ply_t checkPly = ply - 4; checkPly >= minPly; checkPly -= 2) {
-				if (searchVariablePtr[checkPly]->positionHashSignature == searchVariablePtr[ply]->positionHashSignature) {
-					drawByRepetition = true;
-					break;
-				}
-			}
-			return drawByRepetition;
+		void setHashSignature(const MoveGenerator& position, ply_t ply) {
+			SearchVariables& node = *searchVariablePtr[ply];
+			node.setHashSignature(position);
+			_keyHistory.setKey(ply, node.positionHashSignature, node.previousMove.isNullMove());
+		}
+
+		/**
+		 * Check, if there is a two fold repetition in the search tree or with a position played before the root.
+		 */
+		bool isDrawByRepetitionInSearchTree(const Board& board, ply_t ply) const {
+			return _keyHistory.isRepetition(ply, board.getHalfmovesWithoutPawnMoveOrCapture());
+		}
+
+		/**
+		 * Check, if the side to move is able to repeat a position with its next move
+		 */
+		bool hasUpcomingRepetition(const Board& board, ply_t ply) const {
+			return _keyHistory.hasUpcomingRepetition(board, ply, board.getHalfmovesWithoutPawnMoveOrCapture());
 		}
 
 		/**
@@ -135,6 +151,7 @@ namespace QaplaSearch {
 		// We sometimes access the next ply thus we need to have one spare to write data in 
 		array<SearchVariables*, SearchParameter::MAX_SEARCH_DEPTH + 1> searchVariablePtr;
 		array<SearchVariables, SearchParameter::MAX_SEARCH_DEPTH + 1> _stack;
+		KeyHistory _keyHistory;
 		uint32_t referenceCount;
 	};
 
@@ -140,12 +140,14 @@ namespace QaplaSearch {
 
 		/**
 		 * Applies a move
+		 * @param COLOR color of the moving side
 		 */
+		template <Piece COLOR>
 		void doMove(MoveGenerator& position, Move previousPlyMove) {
 			previousMove = previousPlyMove;
 			boardState = position.getBoardState();
 			position.doMove(previousMove);
-			sideToMoveIsInCheck = position.isInCheck();
+			sideToMoveIsInCheck = position.isInCheck<opponentColor<COLOR>()>();
 #ifdef USE_STOCKFISH_EVAL
 			Stockfish::Engine::doMove(previousMove, si);
 #endif
@@ -270,11 +272,12 @@ namespace QaplaSearch {
 
 		/**
 		 * Generates all moves in the current position
+		 * @param COLOR color to move
 		 */
+		template <Piece COLOR>
 		void computeMoves(MoveGenerator& position, ButterflyBoard& butterflyBoard) {
-			position.isWhiteToMove();
-			checkingBitmaps = position.computeCheckBitmapsForMovingColor();
-			moveProvider.computeMoves(position, butterflyBoard, previousMove, ttMove);
+			checkingBitmaps = position.computeCheckBitmaps<opponentColor<COLOR>()>();
+			moveProvider.computeMoves<COLOR>(position, butterflyBoard, previousMove, ttMove);
 			bestValue = moveProvider.checkForGameEnd(position, ply);
 		}
 
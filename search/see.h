@@ -79,18 +79,23 @@ namespace QaplaSearch {
 		 * @returns true, if moving piece is move valuable than the captured piece and the captured piece is defended by a pawn
 		 */
 		static bool isLoosingCaptureLight(const MoveGenerator & position, Move move) {
-			bool result = false;
+			return position.isWhiteToMove() ? 
+				isLoosingCaptureLight<WHITE>(position, move) : isLoosingCaptureLight<BLACK>(position, move);
+		}
+
+		/**
+		 * Variant of isLoosingCaptureLight with the color to move known at compile time
+		 */
+		template <Piece COLOR>
+		static bool isLoosingCaptureLight(const MoveGenerator& position, Move move) {
 			value_t movingPieceValue = position.getPieceValueForMoveSorting(move.getMovingPiece());
 			value_t capturedPieceValue = position.getPieceValueForMoveSorting(move.getCapture());
-			if (position.isWhiteToMove()) {
-				result = (movingPieceValue > -capturedPieceValue) && 
+			if (COLOR == WHITE) {
+				return (movingPieceValue > -capturedPieceValue) && 
 					isDefendedByPawn<BLACK>(position, move.getDestination());
 			}
-			else {
-				result = (-movingPieceValue > capturedPieceValue) && 
-					isDefendedByPawn<WHITE>(position, move.getDestination());
-			}
-			return result;
+			return (-movingPieceValue > capturedPieceValue) && 
+				isDefendedByPawn<WHITE>(position, move.getDestination());
 		}
 
 		/**
@@ -43,9 +43,11 @@ namespace QaplaSearch {
 
 		TT() { 
 			clear(); 
-			_pawnTT.setSizeInKilobytes(1024);
+			_pawnTT.setSizeInKilobytes(DEFAULT_PAWN_TT_SIZE_IN_KILOBYTES);
 		}
 
+		static const int32_t DEFAULT_PAWN_TT_SIZE_IN_KILOBYTES = 1024;
+
 		/**
 		 * Clears the transposition table
 		 */
@@ -64,6 +66,13 @@ namespace QaplaSearch {
 			return &_pawnTT;
 		}
 
+		/**
+		 * Sets the size of the pawn transposition table in kilobytes
+		 */
+		void setPawnTTSizeInKilobytes(int32_t sizeInKiloBytes) {
+			_pawnTT.setSizeInKilobytes(sizeInKiloBytes);
+		}
+
 		/**
 		 * For assertions
 		 */
@@ -0,0 +1,110 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Implements test cases for the batched evaluation: every result of Eval::evalBatch
+ * must match the evaluation and the full feature index vector of the single position
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include "../search/boardadapter.h"
+#include "../interface/fenscanner.h"
+#include "../eval/eval.h"
+
+namespace ChessTest {
+
+	struct EvalBatchTest {
+		EvalBatchTest() : ok(0), fail(0) {}
+		~EvalBatchTest() { printResult(); }
+
+		/**
+		 * Evaluates the positions in a batch and compares every result with the single position evaluation
+		 */
+		void test(const std::vector<QaplaMoveGenerator::MoveGenerator>& positions, uint32_t threadCount) {
+			std::vector<QaplaBasics::PositionSnapshot> snapshots;
+			for (const auto& position : positions) {
+				snapshots.push_back(position.getSnapshot());
+			}
+			const auto results = ChessEval::Eval::evalBatch(snapshots, threadCount, true);
+			bool success = results.size() == positions.size();
+			for (size_t index = 0; success && index < positions.size(); index++) {
+				QaplaMoveGenerator::MoveGenerator position = positions[index];
+				const value_t expected = ChessEval::Eval::eval(position);
+				const auto expectedIndices = ChessEval::Eval().computeIndexVector(position, true);
+				if (results[index].value != expected || !isIdentical(results[index].indexVector, expectedIndices)) {
+					std::cout << "Position " << index << " value: " << results[index].value << " expected: " << expected
+						<< " features: " << results[index].indexVector.size() << " expected: " << expectedIndices.size() << std::endl;
+					success = false;
+				}
+			}
+			const std::string message = "Batch eval of " + std::to_string(positions.size())
+				+ " positions with " + std::to_string(threadCount) + " threads";
+			if (success) {
+				std::cout << message << " ok " << std::endl;
+				ok++;
+			}
+			else {
+				std::cout << message << " failed" << std::endl;
+				fail++;
+			}
+		}
+
+		/**
+		 * Tests the positions and the positions after every of their moves
+		 */
+		void run(const std::vector<std::string>& fens) {
+			std::vector<QaplaMoveGenerator::MoveGenerator> positions;
+			QaplaSearch::BoardAdapter::PositionSetup setup;
+			for (const auto& fen : fens) {
+				if (!QaplaInterface::FenScanner().setBoard(fen, &setup)) continue;
+				positions.push_back(setup.position);
+				QaplaBasics::MoveList moveList;
+				setup.position.genMovesOfMovingColor(moveList);
+				for (uint32_t moveNo = 0; moveNo < moveList.getTotalMoveAmount(); moveNo++) {
+					positions.push_back(setup.position);
+					positions.back().doMove(moveList[moveNo]);
+				}
+			}
+			test(positions, 1);
+			test(positions, 4);
+		}
+
+		void printResult() {
+			std::cout << "ok: " << ok << " fail: " << fail << std::endl;
+		}
+
+	private:
+		static bool isIdentical(const ChessEval::IndexVector& found, const ChessEval::IndexVector& expected) {
+			if (found.size() != expected.size()) return false;
+			for (size_t index = 0; index < found.size(); index++) {
+				if (found[index].name != expected[index].name || found[index].index != expected[index].index
+					|| found[index].color != expected[index].color) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		uint32_t ok;
+		uint32_t fail;
+	};
+
+}
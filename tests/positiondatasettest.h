@@ -0,0 +1,175 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Implements test cases for the binary position dataset: positions written by the
+ * PositionDatasetWriter (as the convert command does) are read back by the
+ * PositionDatasetReader, and every pass visits every record exactly once
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <iostream>
+#include "../training/position-dataset.h"
+
+namespace ChessTest {
+
+	struct PositionDatasetTest {
+		PositionDatasetTest() : ok(0), fail(0) {}
+		~PositionDatasetTest() { printResult(); }
+
+		void test(bool success, const std::string& message) {
+			if (success) {
+				std::cout << message << " ok " << std::endl;
+				ok++;
+			}
+			else {
+				std::cout << message << " failed" << std::endl;
+				fail++;
+			}
+		}
+
+		/**
+		 * Writes the positions and checks, that the reader returns identical records
+		 */
+		void testRoundTrip(const std::vector<std::string>& fens) {
+			std::vector<QaplaTraining::PackedPosition> written;
+			QaplaTraining::PositionDatasetWriter writer;
+			bool success = writer.open(FILENAME);
+			for (const auto& fen : fens) {
+				QaplaTraining::PackedPosition position;
+				if (!position.setFen(fen)) {
+					std::cout << "Not a valid position: " << fen << std::endl;
+					success = false;
+					continue;
+				}
+				position.score = int16_t(written.size());
+				position.eval = -int16_t(written.size());
+				position.result = QaplaTraining::PositionResult(written.size() % 4);
+				writer.write(position);
+				written.push_back(position);
+			}
+			success = writer.close() && success;
+
+			QaplaTraining::PositionDatasetReader reader;
+			success = reader.open(FILENAME) && success && reader.size() == written.size();
+			for (uint64_t index = 0; success && index < reader.size(); index++) {
+				const auto& read = reader[index];
+				if (std::memcmp(&read, &written[index], sizeof(read)) != 0 || read.getFen() != written[index].getFen()) {
+					std::cout << "Record " << index << " differs: " << read.getFen() << std::endl;
+					success = false;
+				}
+			}
+			reader.close();
+			std::remove(FILENAME);
+			test(success, "Round trip of " + std::to_string(fens.size()) + " positions");
+		}
+
+		/**
+		 * Checks, that a sequential and a shuffled pass shared by several threads visit every record once
+		 */
+		void testPasses(uint64_t count, uint64_t seed, uint32_t threadCount) {
+			QaplaTraining::PositionDatasetWriter writer;
+			bool success = writer.open(FILENAME);
+			for (uint64_t index = 0; index < count; index++) {
+				// The reader does not interpret the records, thus occupied serves as record number
+				QaplaTraining::PackedPosition position{};
+				position.occupied = index;
+				writer.write(position);
+			}
+			success = writer.close() && success;
+
+			QaplaTraining::PositionDatasetReader reader;
+			success = reader.open(FILENAME) && success && reader.size() == count;
+			if (success) {
+				success = visitsEveryRecordOnce(reader, threadCount, false);
+				reader.shuffle(seed);
+				success = visitsEveryRecordOnce(reader, threadCount, true) && success;
+			}
+			reader.close();
+			std::remove(FILENAME);
+			test(success, "Passes over " + std::to_string(count) + " records with "
+				+ std::to_string(threadCount) + " threads");
+		}
+
+		void run(const std::vector<std::string>& fens) {
+			std::vector<std::string> positions = fens;
+			// Castling rights, en passant and the halfmove counter
+			positions.push_back("r3k2r/8/8/8/8/8/8/R3K2R b Qk - 37 60");
+			positions.push_back("rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3");
+			positions.push_back("rnbqkbnr/pppp1ppp/8/8/3Pp3/4P3/PPP2PPP/RNBQKBNR b KQkq d3 0 3");
+			testRoundTrip(positions);
+			for (uint64_t count : { 0, 1, 2, 5, 16, 17, 1000, 4097, 100000 }) {
+				testPasses(count, count + 1, 1);
+			}
+			testPasses(100000, 7, 4);
+		}
+
+		void printResult() {
+			std::cout << "ok: " << ok << " fail: " << fail << std::endl;
+		}
+
+	private:
+		static bool visitsEveryRecordOnce(QaplaTraining::PositionDatasetReader& reader, uint32_t threadCount, bool shuffled) {
+			const uint64_t count = reader.size();
+			std::vector<std::atomic<uint32_t>> visits(count);
+			std::atomic<uint64_t> outOfRange = 0;
+			std::atomic<uint64_t> inOrder = 0;
+			auto worker = [&]() {
+				uint64_t last = 0;
+				for (auto record = reader.next(); record != nullptr; record = reader.next()) {
+					if (record->occupied >= count) {
+						outOfRange++;
+						continue;
+					}
+					visits[record->occupied]++;
+					if (record->occupied == last + 1) inOrder++;
+					last = record->occupied;
+				}
+			};
+			std::vector<std::thread> threads;
+			for (uint32_t threadNo = 1; threadNo < threadCount; threadNo++) {
+				threads.emplace_back(worker);
+			}
+			worker();
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			bool success = outOfRange == 0;
+			for (const auto& visit : visits) {
+				success = success && visit == 1;
+			}
+			// A shuffled pass over many records hardly ever follows the file order
+			if (shuffled && count >= 1000 && inOrder > count / 2) {
+				std::cout << "The shuffled pass follows the file order" << std::endl;
+				success = false;
+			}
+			return success;
+		}
+
+		static constexpr const char* FILENAME = "positiondatasettest.bin";
+		uint32_t ok;
+		uint32_t fail;
+	};
+
+}
@@ -24,9 +24,12 @@
 //#include "EPDTest.h"
 #include <fstream>
 #include <sstream>
+#include <algorithm>
 #include <vector>
+#include <tuple>
 #include "../basics/types.h"
 #include "../basics/evalvalue.h"
+#include "../basics/move.h"
 #include "../interface/ichessboard.h"
 
 using namespace std;
@@ -84,6 +87,37 @@ namespace QaplaTraining {
             return storeMove;
         }
 
+        /**
+         * Adds a move to the game without a LAN round trip.
+         *
+         * @param move       Move played
+         * @param value      Computed value in range [-1024, 1023]
+         * @return           false, if the move cannot be stored (underpromotion); recording stops then
+         */
+        bool addMove(QaplaBasics::Move move, value_t value) {
+            if (stopRecordingMoves) {
+                return false;
+            }
+            const QaplaBasics::Piece promotion = move.getPromotion();
+            const bool storeMove = !move.isEmpty() &&
+                (promotion == QaplaBasics::NO_PIECE || QaplaBasics::getPieceType(promotion) == QaplaBasics::QUEEN);
+            if (storeMove) {
+                moves.push_back(encode(move.getDeparture(), move.getDestination(),
+                    promotion != QaplaBasics::NO_PIECE, value));
+            }
+            stopRecordingMoves = !storeMove;
+            return storeMove;
+        }
+
+        /**
+         * Returns departure square, destination square and queen promotion flag of the move at the given index.
+         */
+        std::tuple<uint32_t, uint32_t, bool> getMoveSquares(size_t index) const {
+            if (index >= moves.size()) return { 0, 0, false };
+            const uint32_t move = moves[index];
+            return { (move >> 6) & 0x3F, move & 0x3F, (move & 0x800000) != 0 };
+        }
+
         /**
          * Returns the move at the given index as a LAN string.
          *
@@ -179,22 +213,26 @@ namespace QaplaTraining {
         std::pair<uint32_t, bool> encodeMoveEval(
             const std::string& lan, value_t staticEval)
         {
-			constexpr value_t MAX_EVAL = 1023;
             auto [moveCode, valid] = encodeLAN(lan);
             if (!valid) {
                 return { 0, false };
             }
+            return { encode(moveCode >> 6 & 0x3F, moveCode & 0x3F, lan.length() == 5, staticEval), true };
+        }
 
+        /**
+         * Encodes departure, destination and evaluation into a 24-bit value.
+         * Bits 0-11 hold the squares, bits 12-22 the evaluation and bit 23 flags a promotion to queen.
+         */
+        static uint32_t encode(uint32_t from, uint32_t to, bool isPromotion, value_t staticEval) {
+			constexpr value_t MAX_EVAL = 1023;
 			staticEval = std::clamp(staticEval, -MAX_EVAL, MAX_EVAL);
-           
-            uint16_t evalBits = static_cast<uint16_t>(staticEval + MAX_EVAL + 1);
-            uint32_t encoded = (static_cast<uint32_t>(evalBits) << 12) | moveCode;
-
-            if (lan.length() == 5) {
+            const uint16_t evalBits = static_cast<uint16_t>(staticEval + MAX_EVAL + 1);
+            uint32_t encoded = (static_cast<uint32_t>(evalBits) << 12) | (from << 6) | to;
+            if (isPromotion) {
                 encoded |= 0x800000; // Set promotion flag in bit 23
             }
-
-            return { encoded, true };
+            return encoded;
         }
 
         /**
@@ -261,6 +299,22 @@ namespace QaplaTraining {
             }
         }
 
+        /**
+         * Constructs a reader for the records in the byte range [begin, end) of a file.
+         * Both offsets must be record boundaries, see computeShardOffsets.
+         *
+         * @param filename Path to the input file
+         * @param begin    Offset of the first record
+         * @param end      Offset behind the last record
+         */
+        GameRecordReader(const std::string& filename, std::streamoff begin, std::streamoff end)
+            : GameRecordReader(filename) {
+            end_ = end;
+            if (in.is_open()) {
+                in.seekg(begin);
+            }
+        }
+
         /**
          * Destructor. Closes the file if open.
          */
@@ -278,9 +332,37 @@ namespace QaplaTraining {
          */
         bool read(GameRecord& game) {
             if (!in.is_open()) return false;
+            if (end_ >= 0 && in.tellg() >= end_) return false;
             return static_cast<bool>(in >> game);
         }
 
+        /**
+         * Splits a file into shards of about equal size on record boundaries. Only the 
+         * record lengths are read.
+         *
+         * @param filename Path to the input file
+         * @param shards   Number of shards
+         * @return         shards + 1 offsets, shard i covers [offsets[i], offsets[i + 1])
+         */
+        static std::vector<std::streamoff> computeShardOffsets(const std::string& filename, uint32_t shards) {
+            std::ifstream file(filename, std::ios::binary | std::ios::ate);
+            const std::streamoff fileSize = file ? std::streamoff(file.tellg()) : 0;
+            file.seekg(0);
+            std::vector<std::streamoff> offsets{ 0 };
+            std::streamoff offset = 0;
+            uint16_t length = 0;
+            for (uint32_t shard = 1; shard < shards; ++shard) {
+                const std::streamoff target = fileSize * shard / shards;
+                while (offset < target && file.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+                    file.ignore(length);
+                    offset += sizeof(length) + length;
+                }
+                offsets.push_back(std::min(offset, fileSize));
+            }
+            offsets.push_back(fileSize);
+            return offsets;
+        }
+
         /**
          * Returns true if the end of file has been reached.
          *
@@ -292,6 +374,8 @@ namespace QaplaTraining {
 
     private:
         std::ifstream in;
+        // Offset behind the last record to read or -1 to read to the end of the file
+        std::streamoff end_ = -1;
     };
 
     /**
@@ -23,6 +23,9 @@
 
 #include <string>
 #include <functional>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 #include "game-record.h"
 #include "../interface/ichessboard.h"
 #include "../interface/chessinterface.h"
@@ -56,11 +59,13 @@ namespace QaplaTraining {
      * - On new game start
      * - On move played
      * - On replay finished
+     * The games can be replayed sequentially or in parallel on shards of the file.
      */
     class GameReplayEngine {
     public:
         using MoveCallback = std::function<void(const MoveInfo& move)>;
         using FinishCallback = std::function<void()>;
+        using ShardCallbackFactory = std::function<MoveCallback(uint32_t shard)>;
 
         /**
          * @brief Constructor
@@ -83,65 +88,106 @@ namespace QaplaTraining {
          */
         void run(const std::string& filePath) {
             GameRecordReader reader(filePath);
+            std::atomic<uint64_t> gameCounter = 0;
+            replay(reader, chessEngine_.get(), moveCallback_, gameCounter);
 
+            if (finishCallback_) {
+                std::cout << "\rGames replayed: " << gameCounter << std::endl;
+                finishCallback_();
+            }
+        }
+
+        /**
+         * @brief Replays the games in parallel. The file is split into numThreads shards on 
+         * record boundaries and every shard is replayed by an own engine created by createNew.
+         * createCallback is called once per shard before the threads start and returns the 
+         * move callback of the shard. The callbacks of different shards run concurrently, 
+         * thus each one must only write to data of its own shard. The finish callback is 
+         * called after all shards are replayed, it is the place to merge the shard data.
+         */
+        void runParallel(const std::string& filePath, uint32_t numThreads, const ShardCallbackFactory& createCallback) {
+            const auto offsets = GameRecordReader::computeShardOffsets(filePath, std::max<uint32_t>(1, numThreads));
+            const uint32_t shards = static_cast<uint32_t>(offsets.size() - 1);
+            std::vector<MoveCallback> callbacks;
+            for (uint32_t shard = 0; shard < shards; ++shard) {
+                callbacks.push_back(createCallback(shard));
+            }
+
+            std::atomic<uint64_t> gameCounter = 0;
+            std::vector<std::thread> threads;
+            for (uint32_t shard = 0; shard < shards; ++shard) {
+                threads.emplace_back([this, &filePath, &offsets, &callbacks, &gameCounter, shard]() {
+                    std::unique_ptr<QaplaInterface::IChessBoard> engine(chessEngine_->createNew());
+                    GameRecordReader reader(filePath, offsets[shard], offsets[shard + 1]);
+                    replay(reader, engine.get(), callbacks[shard], gameCounter);
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            if (finishCallback_) {
+                std::cout << "\rGames replayed: " << gameCounter << std::endl;
+                finishCallback_();
+            }
+        }
+
+    private:
+        std::vector<std::string> fenList_;
+        std::unique_ptr<QaplaInterface::IChessBoard> chessEngine_;
+        MoveCallback moveCallback_;
+        FinishCallback finishCallback_;
+
+        /**
+         * @brief Replays all games of a reader on engine
+         */
+        void replay(GameRecordReader& reader, QaplaInterface::IChessBoard* engine, 
+            const MoveCallback& moveCallback, std::atomic<uint64_t>& gameCounter) const {
             QaplaTraining::GameRecord game;
-			uint64_t gameCounter = 0;
-            bool error = false;
 
             while (reader.read(game)) {
                 
-				gameCounter++;
+                const uint64_t gamesReplayed = ++gameCounter;
                 // Reset board to initial position
                 const auto fenId = game.getFENId();
-                error = !setupBoardFromFEN(fenId);
-				if (error) {
+                if (!setupBoardFromFEN(fenId, engine)) {
 					std::cerr << "Error: Invalid FEN ID: " << fenId << std::endl;
 					break;
 				}
 
-                MoveInfo moveInfo(fenId, fenList_[fenId], chessEngine_.get(), game.getResult());
+                MoveInfo moveInfo(fenId, fenList_[fenId], engine, game.getResult());
 
                 // Notify start of new game
-                if (moveCallback_) {
-                    value_t eval = chessEngine_->eval();
-                    moveCallback_(moveInfo);
+                if (moveCallback) {
+                    moveCallback(moveInfo);
                 }
 				moveInfo.gameStarting = false;
                 for (size_t index = 0; index < game.numMoves(); ++index) {
 					moveInfo.move = game.getMove(index);
 					moveInfo.value = game.getValue(index);
 					moveInfo.moveNo = static_cast<uint32_t>(index / 2 + 1);
-                    bool isLegal = setMove(moveInfo);
+					const auto [departure, destination, promotion] = game.getMoveSquares(index);
+					const QaplaBasics::Move move = engine->findMove(departure, destination, promotion ? 'q' : 0);
+                    bool isLegal = setMove(moveInfo, move, moveCallback);
 					if (!isLegal) {
 						std::cerr << "Error: Invalid move at index " << index << " fen id " << fenId << std::endl;
 						break;
 					}
                 }
-				if (gameCounter % 10000 == 0) {
-					std::cout << "\rGames replayed: " << gameCounter << std::flush;
+				if (gamesReplayed % 10000 == 0) {
+					std::cout << "\rGames replayed: " << gamesReplayed << std::flush;
 				}
             }
-
-            if (finishCallback_) {
-                std::cout << "\rGames replayed: " << gameCounter << std::endl;
-                finishCallback_();
-            }
         }
 
-    private:
-        std::vector<std::string> fenList_;
-        std::unique_ptr<QaplaInterface::IChessBoard> chessEngine_;
-        MoveCallback moveCallback_;
-        FinishCallback finishCallback_;
-
         /**
-         * @brief Sets up the internal board state from a FEN string
-         * @param fen The FEN string representing the initial position
+         * @brief Sets up the board state of an engine from a FEN string
+         * @param fenId Index of the FEN string representing the initial position
 		 * @return true if successful, false otherwise
          */
-        bool setupBoardFromFEN(uint32_t fenId) {
+        bool setupBoardFromFEN(uint32_t fenId, QaplaInterface::IChessBoard* engine) const {
             if (fenId < fenList_.size()) {
-				QaplaInterface::ChessInterface::setPositionByFen(fenList_[fenId], chessEngine_.get());
+				QaplaInterface::ChessInterface::setPositionByFen(fenList_[fenId], engine);
 				return true;
             }
 			else {
@@ -150,13 +196,17 @@ namespace QaplaTraining {
 			}
         }
 
-		bool setMove(MoveInfo& moveInfo) {
-			moveInfo.isCapture = QaplaInterface::ChessInterface::isCapture(moveInfo.move, moveInfo.engine);
+		/**
+		 * @brief Reports the move to the callback and plays it
+		 * @param move Move of moveInfo, found on the engine board
+		 */
+		static bool setMove(MoveInfo& moveInfo, QaplaBasics::Move move, const MoveCallback& moveCallback) {
+			moveInfo.isCapture = move.isCapture();
 			moveInfo.eval = moveInfo.engine->eval();
-            if (moveCallback_) {
-                moveCallback_(moveInfo);
+            if (moveCallback) {
+                moveCallback(moveInfo);
             }
-			bool isLegalMove = QaplaInterface::ChessInterface::setMove(moveInfo.move, moveInfo.engine);
+			bool isLegalMove = moveInfo.engine->doMove(move);
             if (!isLegalMove) {
                 std::cerr << "Error: Illegal move: " << moveInfo.move << std::endl;
                 return false;
@@ -169,5 +219,3 @@ namespace QaplaTraining {
 
 
 } // namespace QaplaTraining
-
-
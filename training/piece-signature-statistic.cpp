@@ -19,9 +19,11 @@
 
 #include <algorithm>
 #include <fstream>
+#include <memory>
 #include <unordered_map>
 #include "../basics/piecesignature.h"
 #include "piece-signature-statistic.h"
+#include "game-replay-engine.h"
 
 using namespace QaplaBasics;
 
@@ -72,6 +74,61 @@ namespace QaplaTraining {
 		in.close();
 	}
 
+	void PieceSignatureStatistic::run(const std::vector<std::string>& fenList,
+		const QaplaInterface::IChessBoard* engine,
+		const std::string& filePath, uint32_t numThreads) {
+		GameReplayEngine replayEngine(engine, fenList);
+		// Every shard collects into an own statistic, they are merged after the replay
+		std::vector<std::unique_ptr<ShardStatistic>> shards;
+		replayEngine.setFinishCallback([this, &shards]() {
+			for (const auto& shard : shards) {
+				shard->finishGame();
+				merge(*shard);
+			}
+			saveToFile("result.bin");
+			});
+		replayEngine.runParallel(filePath, numThreads, [&shards](uint32_t) {
+			shards.push_back(std::make_unique<ShardStatistic>());
+			ShardStatistic* shard = shards.back().get();
+			return [shard](const MoveInfo& moveInfo) { onMove(moveInfo, *shard); };
+			});
+	}
+
+	void PieceSignatureStatistic::onMove(const MoveInfo& moveInfo, ShardStatistic& statistic) {
+		if (moveInfo.gameStarting) {
+			statistic.finishGame();
+			statistic.gameResult = moveInfo.result;
+			return;
+		}
+		// Only quiet positions after a capture sequence, as in the signature eval adjuster
+		if (!moveInfo.moveBeforeWasCapture || moveInfo.isCapture) return;
+		const auto& indexVector = moveInfo.engine->computeEvalIndexVector();
+		if (indexVector.empty() || indexVector[0].name != "pieceSignature") return;
+		const int32_t whiteValue = moveInfo.engine->isWhiteToMove() ? moveInfo.value : -moveInfo.value;
+		const int32_t valueBucket = std::clamp((whiteValue + (whiteValue >= 0 ? 50 : -50)) / 100, -3, 3);
+		statistic.gameIndexes.push_back(indexVector[0].index * 8 + valueBucket + 3);
+	}
+
+	void PieceSignatureStatistic::ShardStatistic::finishGame() {
+		std::sort(gameIndexes.begin(), gameIndexes.end());
+		gameIndexes.erase(std::unique(gameIndexes.begin(), gameIndexes.end()), gameIndexes.end());
+		for (auto index : gameIndexes) {
+			if (QaplaInterface::isWhiteWin(gameResult)) results[index].win++;
+			else if (QaplaInterface::isBlackWin(gameResult)) results[index].loss++;
+			else if (QaplaInterface::isDraw(gameResult)) results[index].draw++;
+		}
+		gameIndexes.clear();
+	}
+
+	void PieceSignatureStatistic::merge(const ShardStatistic& statistic) {
+		for (const auto& [index, count] : statistic.results) {
+			if (index >= signatureWin.size()) continue;
+			signatureWin[index] += count.win;
+			signatureDraw[index] += count.draw;
+			signatureLoss[index] += count.loss;
+		}
+	}
+
 	void PieceSignatureStatistic::generateResultTableOnce() {
 		PieceSignatureStatistic stat;
 		stat.loadFromFile("result.bin");
@@ -90,7 +147,7 @@ namespace QaplaTraining {
 			total += computeTotal(vSig) + computeTotal(vSigSym);
 			win += signatureWin[vSig] - signatureWin[vSigSym] - signatureLoss[vSig] + signatureLoss[vSigSym];
 		}
-		return (win) * 100 / total;
+		return total == 0 ? 0 : win * 100 / total;
 	}
 
 	int64_t PieceSignatureStatistic::computeTotalForPieceOnlySignature(uint32_t wsig, uint32_t bsig) {
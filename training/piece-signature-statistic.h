@@ -24,13 +24,17 @@
 //#include "EPDTest.h"
 #include <fstream>
 #include <vector>
+#include <string>
+#include <unordered_map>
 #include "../basics/piecesignature.h"
+#include "../interface/ichessboard.h"
 
 using namespace std;
 
 namespace QaplaTraining {
 
 	class GamePairing;
+	struct MoveInfo;
 
 	struct PieceSignatureStatistic {
 		PieceSignatureStatistic()
@@ -47,7 +51,47 @@ namespace QaplaTraining {
 
 		void generateResultTableOnce();
 
+		/**
+		 * Replays a binary game file and counts the game results per piece signature and 
+		 * search value bucket. Every signature and bucket is counted once per game.
+		 * @param fenList List of all possible FEN strings
+		 * @param engine  Prototype chess engine
+		 * @param filePath Path to the binary game file
+		 * @param numThreads Number of threads replaying shards of the file in parallel
+		 */
+		void run(const std::vector<std::string>& fenList,
+			const QaplaInterface::IChessBoard* engine,
+			const std::string& filePath, uint32_t numThreads = 1);
+
 	private:
+		/**
+		 * Results collected by one replay shard. Indexes are stored sparse, as a game 
+		 * file reaches only a small part of all signatures
+		 */
+		struct ShardStatistic {
+			struct ResultCount {
+				int64_t win = 0;
+				int64_t draw = 0;
+				int64_t loss = 0;
+			};
+			std::unordered_map<uint32_t, ResultCount> results;
+			// Indexes (signature * 8 + value bucket) reached in the current game
+			std::vector<uint32_t> gameIndexes;
+			QaplaInterface::GameResult gameResult = QaplaInterface::GameResult::NOT_ENDED;
+
+			/**
+			 * Counts the result of the current game for all indexes reached in the game
+			 */
+			void finishGame();
+		};
+
+		static void onMove(const MoveInfo& moveInfo, ShardStatistic& statistic);
+
+		/**
+		 * Adds the results of a shard
+		 */
+		void merge(const ShardStatistic& statistic);
+
 		void applyFullBoardDamping(
 			std::vector<int32_t>& resultTable,
 			double fullBoardWeight,         // e.g. 0.5
@@ -80,8 +124,6 @@ namespace QaplaTraining {
 		std::vector<int64_t> signatureWin;
 		std::vector<int64_t> signatureDraw;
 		std::vector<int64_t> signatureLoss;
-
-		
 	};
 
 }
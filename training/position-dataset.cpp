@@ -0,0 +1,307 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Binary position dataset for training
+ */
+
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include "position-dataset.h"
+#include "../basics/bits.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace QaplaTraining {
+
+    using namespace QaplaBasics;
+    using QaplaInterface::GameResult;
+
+    bool PackedPosition::setFen(const std::string& fen) {
+        *this = PackedPosition{};
+        epFile = NO_EP;
+        result = PositionResult::UNKNOWN;
+        std::istringstream in(fen);
+        std::string board, side, castling, ep;
+        uint32_t halfmoves = 0;
+        in >> board >> side >> castling >> ep;
+        if (!(in >> halfmoves)) halfmoves = 0;
+
+        std::array<Piece, BOARD_SIZE> squares;
+        squares.fill(NO_PIECE);
+        int32_t file = 0;
+        int32_t rank = 7;
+        for (char ch : board) {
+            if (ch == '/') {
+                if (file != 8 || rank == 0) return false;
+                file = 0;
+                rank--;
+            }
+            else if (ch >= '1' && ch <= '8') {
+                file += ch - '0';
+            }
+            else {
+                const Piece piece = charToPiece(ch);
+                if (piece == NO_PIECE || file > 7) return false;
+                squares[rank * 8 + file] = piece;
+                file++;
+            }
+            if (file > 8) return false;
+        }
+        if (file != 8 || rank != 0) return false;
+
+        uint32_t pieceCount = 0;
+        for (uint32_t square = 0; square < BOARD_SIZE; square++) {
+            if (squares[square] == NO_PIECE) continue;
+            if (pieceCount >= 32) return false;
+            occupied |= 1ULL << square;
+            setPiece(pieceCount, squares[square]);
+            pieceCount++;
+        }
+
+        if (side == "b") flags |= BLACK_TO_MOVE;
+        for (char ch : castling) {
+            if (ch == 'K') flags |= WHITE_KING_SIDE;
+            else if (ch == 'Q') flags |= WHITE_QUEEN_SIDE;
+            else if (ch == 'k') flags |= BLACK_KING_SIDE;
+            else if (ch == 'q') flags |= BLACK_QUEEN_SIDE;
+        }
+        if (ep.size() == 2 && ep[0] >= 'a' && ep[0] <= 'h') {
+            epFile = uint8_t(ep[0] - 'a');
+        }
+        halfmovesWithoutPawnMoveOrCapture = uint8_t(std::min<uint32_t>(halfmoves, 255));
+        return true;
+    }
+
+    std::string PackedPosition::getFen() const {
+        std::array<Piece, BOARD_SIZE> squares;
+        squares.fill(NO_PIECE);
+        uint32_t index = 0;
+        for (bitBoard_t bits = occupied; bits; bits &= bits - 1) {
+            squares[lsb(bits)] = getPiece(index++);
+        }
+
+        std::string fen;
+        for (int32_t rank = 7; rank >= 0; rank--) {
+            uint32_t empty = 0;
+            for (int32_t file = 0; file < 8; file++) {
+                const Piece piece = squares[rank * 8 + file];
+                if (piece == NO_PIECE) {
+                    empty++;
+                    continue;
+                }
+                if (empty > 0) fen += char('0' + empty);
+                empty = 0;
+                fen += pieceToChar(piece);
+            }
+            if (empty > 0) fen += char('0' + empty);
+            if (rank > 0) fen += '/';
+        }
+        fen += isWhiteToMove() ? " w " : " b ";
+        const size_t castlingStart = fen.size();
+        if (flags & WHITE_KING_SIDE) fen += 'K';
+        if (flags & WHITE_QUEEN_SIDE) fen += 'Q';
+        if (flags & BLACK_KING_SIDE) fen += 'k';
+        if (flags & BLACK_QUEEN_SIDE) fen += 'q';
+        if (fen.size() == castlingStart) fen += '-';
+        if (epFile == NO_EP) {
+            fen += " -";
+        }
+        else {
+            fen += ' ';
+            fen += char('a' + epFile);
+            fen += isWhiteToMove() ? '6' : '3';
+        }
+        fen += " " + std::to_string(halfmovesWithoutPawnMoveOrCapture) + " 1";
+        return fen;
+    }
+
+    PositionResult PackedPosition::toPositionResult(GameResult result) {
+        switch (result) {
+        case GameResult::WHITE_WINS_BY_MATE: 
+        case GameResult::WHITE_WINS_BY_ADJUDICATION: return PositionResult::WHITE_WINS;
+        case GameResult::BLACK_WINS_BY_MATE: 
+        case GameResult::BLACK_WINS_BY_ADJUDICATION: return PositionResult::BLACK_WINS;
+        case GameResult::DRAW_BY_REPETITION:
+        case GameResult::DRAW_BY_50_MOVES_RULE:
+        case GameResult::DRAW_BY_STALEMATE:
+        case GameResult::DRAW_BY_NOT_ENOUGHT_MATERIAL: 
+        case GameResult::DRAW_BY_ADJUDICATION: return PositionResult::DRAW;
+        default: return PositionResult::UNKNOWN;
+        }
+    }
+
+    bool PositionDatasetWriter::open(const std::string& filename) {
+        close();
+        out.open(filename, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Failed to open file for writing: " << filename << std::endl;
+            return false;
+        }
+        header = PositionDatasetHeader{};
+        buffer.reserve(BUFFER_SIZE);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        return static_cast<bool>(out);
+    }
+
+    void PositionDatasetWriter::write(const PackedPosition& position) {
+        buffer.push_back(position);
+        header.count++;
+        if (buffer.size() >= BUFFER_SIZE) {
+            flush();
+        }
+    }
+
+    void PositionDatasetWriter::flush() {
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(PackedPosition));
+        buffer.clear();
+    }
+
+    bool PositionDatasetWriter::close() {
+        if (!out.is_open()) return true;
+        flush();
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        const bool success = static_cast<bool>(out);
+        out.close();
+        return success;
+    }
+
+    bool PositionDatasetReader::open(const std::string& filename) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        GetFileSizeEx(file, &fileSize);
+        HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (fileMapping == nullptr) {
+            CloseHandle(file);
+            return false;
+        }
+        fileHandle = file;
+        mappingHandle = fileMapping;
+        mappingSize = size_t(fileSize.QuadPart);
+        mapping = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        const int file = ::open(filename.c_str(), O_RDONLY);
+        if (file < 0) return false;
+        struct stat fileStat;
+        if (fstat(file, &fileStat) != 0 || size_t(fileStat.st_size) < sizeof(PositionDatasetHeader)) {
+            ::close(file);
+            return false;
+        }
+        mappingSize = size_t(fileStat.st_size);
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, file, 0);
+        // The mapping stays valid after closing the descriptor
+        ::close(file);
+        if (mapping == MAP_FAILED) mapping = nullptr;
+#endif
+        if (mapping == nullptr || mappingSize < sizeof(PositionDatasetHeader)) {
+            std::cerr << "Failed to map dataset: " << filename << std::endl;
+            close();
+            return false;
+        }
+
+        const auto* header = static_cast<const PositionDatasetHeader*>(mapping);
+        if (header->magic != PositionDatasetHeader::MAGIC || header->version != PositionDatasetHeader::VERSION) {
+            std::cerr << "Not a position dataset: " << filename << std::endl;
+            close();
+            return false;
+        }
+        const uint64_t available = (mappingSize - sizeof(PositionDatasetHeader)) / sizeof(PackedPosition);
+        if (header->count > available) {
+            std::cerr << "Truncated position dataset: " << filename << std::endl;
+        }
+        count = std::min(header->count, available);
+        records = reinterpret_cast<const PackedPosition*>(static_cast<const char*>(mapping) + sizeof(PositionDatasetHeader));
+        rewind();
+        return true;
+    }
+
+    void PositionDatasetReader::close() {
+#ifdef _WIN32
+        if (mapping != nullptr) UnmapViewOfFile(mapping);
+        if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+        if (fileHandle != nullptr) CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        if (mapping != nullptr) munmap(mapping, mappingSize);
+#endif
+        mapping = nullptr;
+        mappingSize = 0;
+        records = nullptr;
+        count = 0;
+    }
+
+    void PositionDatasetReader::rewind() {
+        shuffled = false;
+        cursor = 0;
+#ifndef _WIN32
+        if (mapping != nullptr) madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+#endif
+    }
+
+    void PositionDatasetReader::shuffle(uint64_t seed) {
+        uint32_t bits = 2;
+        while (bits < 64 && (1ULL << bits) < count) bits += 2;
+        halfBits = bits / 2;
+        std::mt19937_64 random(seed);
+        for (auto& key : roundKeys) key = random();
+        shuffled = true;
+        cursor = 0;
+#ifndef _WIN32
+        if (mapping != nullptr) madvise(mapping, mappingSize, MADV_RANDOM);
+#endif
+    }
+
+    uint64_t PositionDatasetReader::permute(uint64_t index) const {
+        const uint64_t mask = (1ULL << halfBits) - 1;
+        do {
+            uint64_t left = index >> halfBits;
+            uint64_t right = index & mask;
+            for (const auto key : roundKeys) {
+                uint64_t hash = (right ^ key) * 0x9E3779B97F4A7C15ULL;
+                hash ^= hash >> 29;
+                const uint64_t newRight = left ^ (hash & mask);
+                left = right;
+                right = newRight;
+            }
+            index = (left << halfBits) | right;
+        } while (index >= count);
+        return index;
+    }
+
+    const PackedPosition* PositionDatasetReader::next() {
+        const uint64_t index = cursor.fetch_add(1, std::memory_order_relaxed);
+        if (index >= count) return nullptr;
+        return &records[shuffled ? permute(index) : index];
+    }
+
+}
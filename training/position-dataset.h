@@ -0,0 +1,225 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Binary position dataset for training. Every position is stored in a fixed size record
+ * of 32 bytes, thus a file is read by mapping it into memory and indexing the records
+ * without any parsing or move replay. The reader hands out the records sequentially or
+ * in a pseudo random permutation that needs no memory per position.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <fstream>
+#include <vector>
+#include "../basics/types.h"
+#include "../basics/bits.h"
+#include "../interface/ichessboard.h"
+
+namespace QaplaTraining {
+
+    /**
+     * Game result from the view of white
+     */
+    enum class PositionResult : uint8_t {
+        BLACK_WINS = 0, DRAW = 1, WHITE_WINS = 2, UNKNOWN = 3
+    };
+
+#pragma pack(push, 1)
+    struct PackedPosition {
+        static constexpr uint8_t BLACK_TO_MOVE = 1;
+        static constexpr uint8_t WHITE_KING_SIDE = 2;
+        static constexpr uint8_t WHITE_QUEEN_SIDE = 4;
+        static constexpr uint8_t BLACK_KING_SIDE = 8;
+        static constexpr uint8_t BLACK_QUEEN_SIDE = 16;
+        static constexpr uint8_t NO_EP = 8;
+
+        // One bit per occupied square, a1 = bit 0
+        uint64_t occupied;
+        // Piece codes (a nibble each) of the occupied squares in ascending square order
+        std::array<uint8_t, 16> pieces;
+        // Search value and static eval from the view of white
+        int16_t score;
+        int16_t eval;
+        // Side to move and castling rights
+        uint8_t flags;
+        // File of the en passant square or NO_EP
+        uint8_t epFile;
+        uint8_t halfmovesWithoutPawnMoveOrCapture;
+        PositionResult result;
+
+        /**
+         * @brief Encodes a position given as FEN
+         * @returns false, if the FEN is not a valid position with at most 32 pieces
+         */
+        bool setFen(const std::string& fen);
+
+        /**
+         * @brief Gets the position as FEN
+         */
+        std::string getFen() const;
+
+        /**
+         * @brief Sets up a board directly from the record
+         * @param board an IChessBoard or any other type with the board setup functions of IChessBoard
+         */
+        template <typename BOARD>
+        void setBoard(BOARD* board) const {
+            board->clearBoard();
+            uint32_t index = 0;
+            for (QaplaBasics::bitBoard_t bits = occupied; bits; bits &= bits - 1) {
+                const uint32_t square = QaplaBasics::lsb(bits);
+                board->setPiece(square % 8, square / 8, QaplaBasics::pieceToChar(getPiece(index++)));
+            }
+            board->setWhiteKingSideCastlingRight((flags & WHITE_KING_SIDE) != 0);
+            board->setWhiteQueenSideCastlingRight((flags & WHITE_QUEEN_SIDE) != 0);
+            board->setBlackKingSideCastlingRight((flags & BLACK_KING_SIDE) != 0);
+            board->setBlackQueenSideCastlingRight((flags & BLACK_QUEEN_SIDE) != 0);
+            board->setWhiteToMove(isWhiteToMove());
+            if (epFile != NO_EP) {
+                // Same rank convention as the fen scanner: rank of the square behind the pawn
+                board->setEPSquare(epFile, isWhiteToMove() ? 5 : 2);
+            }
+            board->setHalfmovesWithoutPawnMoveOrCapture(halfmovesWithoutPawnMoveOrCapture);
+            board->finishBoardSetup();
+        }
+
+        bool isWhiteToMove() const { return (flags & BLACK_TO_MOVE) == 0; }
+
+        /**
+         * @brief Gets the piece of the n-th occupied square
+         */
+        QaplaBasics::Piece getPiece(uint32_t index) const {
+            return QaplaBasics::Piece((pieces[index / 2] >> ((index & 1) * 4)) & 0xF);
+        }
+
+        void setPiece(uint32_t index, QaplaBasics::Piece piece) {
+            pieces[index / 2] |= uint8_t(piece << ((index & 1) * 4));
+        }
+
+        /**
+         * @brief Maps a game result to the result from the view of white
+         */
+        static PositionResult toPositionResult(QaplaInterface::GameResult result);
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(PackedPosition) == 32, "PackedPosition must be 32 bytes");
+
+    /**
+     * File layout: header followed by header.count records
+     */
+    struct PositionDatasetHeader {
+        static constexpr uint32_t MAGIC = 0x53445051; // "QPDS"
+        static constexpr uint32_t VERSION = 1;
+        uint32_t magic = MAGIC;
+        uint32_t version = VERSION;
+        uint64_t count = 0;
+    };
+
+    class PositionDatasetWriter {
+    public:
+        /**
+         * @brief Creates the file and writes a header with a preliminary count
+         */
+        bool open(const std::string& filename);
+
+        void write(const PackedPosition& position);
+
+        /**
+         * @brief Flushes the records and writes the final count to the header
+         */
+        bool close();
+
+        uint64_t size() const { return header.count; }
+
+        ~PositionDatasetWriter() { close(); }
+
+    private:
+        static constexpr size_t BUFFER_SIZE = 4096;
+        void flush();
+
+        std::ofstream out;
+        PositionDatasetHeader header;
+        std::vector<PackedPosition> buffer;
+    };
+
+    class PositionDatasetReader {
+    public:
+        PositionDatasetReader() = default;
+        PositionDatasetReader(const PositionDatasetReader&) = delete;
+        PositionDatasetReader& operator=(const PositionDatasetReader&) = delete;
+        ~PositionDatasetReader() { close(); }
+
+        /**
+         * @brief Maps a dataset file into memory
+         * @returns false, if the file cannot be mapped or has no valid header
+         */
+        bool open(const std::string& filename);
+
+        void close();
+
+        uint64_t size() const { return count; }
+
+        const PackedPosition& operator[](uint64_t index) const { return records[index]; }
+
+        /**
+         * @brief Starts a new pass over all records in file order
+         */
+        void rewind();
+
+        /**
+         * @brief Starts a new pass over all records in a pseudo random order determined by seed
+         */
+        void shuffle(uint64_t seed);
+
+        /**
+         * @brief Gets the next record of the current pass. Thread safe, several threads
+         * may share one pass.
+         * @returns nullptr, if the pass is finished
+         */
+        const PackedPosition* next();
+
+    private:
+        /**
+         * @brief Maps an index of the pass to a record index. Uses a Feistel network on
+         * the next even power of two bits above count and walks the cycle until the
+         * result is in range, thus the mapping is a permutation of [0, count).
+         */
+        uint64_t permute(uint64_t index) const;
+
+        static constexpr uint32_t FEISTEL_ROUNDS = 4;
+
+        const PackedPosition* records = nullptr;
+        uint64_t count = 0;
+        std::atomic<uint64_t> cursor = 0;
+        bool shuffled = false;
+        uint32_t halfBits = 0;
+        std::array<uint64_t, FEISTEL_ROUNDS> roundKeys{};
+
+        void* mapping = nullptr;
+        size_t mappingSize = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+    };
+
+}
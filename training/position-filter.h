@@ -112,10 +112,10 @@ namespace QaplaTraining {
          */
         bool isWinFor(value_t value, QaplaInterface::GameResult result) const {
 
-            if (value > 0 && result == QaplaInterface::GameResult::WHITE_WINS_BY_MATE) {
+            if (value > 0 && QaplaInterface::isWhiteWin(result)) {
                 return true;
             }
-            if (value < 0 && result == QaplaInterface::GameResult::BLACK_WINS_BY_MATE) {
+            if (value < 0 && QaplaInterface::isBlackWin(result)) {
                 return true;
             }
             return false;
@@ -18,9 +18,11 @@
  */
 
 #include <algorithm>
+#include <memory>
 #include "signature-eval-adjuster.h"
 #include "game-replay-engine.h"
 #include "../basics/piecesignature.h"
+#include "../eval/signature-correction.h"
 
 namespace QaplaTraining {
 
@@ -57,18 +59,45 @@ namespace QaplaTraining {
 
 	 void SignatureEvalAdjuster::run(const std::vector<std::string>& fenList,
         const QaplaInterface::IChessBoard* engine,
-        const std::string& filePath) {
+        const std::string& filePath, uint32_t numThreads) {
         GameReplayEngine replayEngine(engine, fenList);
-        replayEngine.setMoveCallback([this](const MoveInfo& moveInfo) {
-            this->onMove(moveInfo);
-            });
-        replayEngine.setFinishCallback([this]() {
+        // Every shard collects into an own statistic, they are merged after the replay
+        std::vector<std::unique_ptr<ShardStatistic>> shards;
+        replayEngine.setFinishCallback([this, &shards]() {
+            for (const auto& shard : shards) {
+                merge(*shard);
+            }
             this->onFinish();
             });
-        replayEngine.run(filePath);
+        replayEngine.runParallel(filePath, numThreads, [this, &shards](uint32_t) {
+            shards.push_back(std::make_unique<ShardStatistic>());
+            ShardStatistic* shard = shards.back().get();
+            shard->signatureStatisticsMg = signatureStatisticsMg;
+            shard->signatureStatisticsEg = signatureStatisticsEg;
+            return [this, shard](const MoveInfo& moveInfo) { this->onMove(moveInfo, *shard); };
+            });
+    }
+
+    void SignatureEvalAdjuster::merge(const ShardStatistic& statistic) {
+        for (const auto& [pieceIndex, count] : statistic.signatures) {
+            signatureWin[pieceIndex] += count.win;
+            signatureDraw[pieceIndex] += count.draw;
+            signatureLoss[pieceIndex] += count.loss;
+            evalSum[pieceIndex] += count.evalSum;
+        }
+        for (size_t index = 0; index < valSum.size(); ++index) {
+            valSum[index] += statistic.valSum[index];
+            valTotal[index] += statistic.valTotal[index];
+        }
+        for (size_t index = 0; index < signatureStatisticsMg.size(); ++index) {
+            signatureStatisticsMg[index].merge(statistic.signatureStatisticsMg[index]);
+        }
+        for (size_t index = 0; index < signatureStatisticsEg.size(); ++index) {
+            signatureStatisticsEg[index].merge(statistic.signatureStatisticsEg[index]);
+        }
     }
 
-     void SignatureEvalAdjuster::onMove(const MoveInfo& moveInfo) {
+     void SignatureEvalAdjuster::onMove(const MoveInfo& moveInfo, ShardStatistic& statistic) const {
          // Skip: we only want evaluation after the last move of a capture sequence,
          // to avoid transient eval noise from ongoing exchanges.
          if (!moveInfo.moveBeforeWasCapture || moveInfo.isCapture) return;
@@ -85,33 +114,36 @@ namespace QaplaTraining {
          }
          auto pieceIndex = indexVector[0].index;
 
-         int64_t currentSum = evalSum[pieceIndex];
+         auto& count = statistic.signatures[pieceIndex];
+         int64_t currentSum = count.evalSum;
          int64_t toAdd = static_cast<int64_t>(moveInfo.eval);
          if ((toAdd > 0 && currentSum > INT64_MAX - toAdd) ||
              (toAdd < 0 && currentSum < INT64_MIN - toAdd)) {
              std::cerr << "Overflow in evalSum for pieceIndex: " << pieceIndex << std::endl;
              return;
          }
-         evalSum[pieceIndex] += toAdd;
-         valTotal[absValue]++;
+         count.evalSum += toAdd;
+         statistic.valTotal[absValue]++;
          int64_t gameResult = 0;
 
          switch (moveInfo.result) {
          case QaplaInterface::GameResult::WHITE_WINS_BY_MATE:
-             signatureWin[pieceIndex]++;
-             valSum[absValue] += whiteValue >= 0 ? 1 : -1;
+         case QaplaInterface::GameResult::WHITE_WINS_BY_ADJUDICATION:
+             count.win++;
+             statistic.valSum[absValue] += whiteValue >= 0 ? 1 : -1;
              gameResult = 1;
              break;
          case QaplaInterface::GameResult::BLACK_WINS_BY_MATE:
-             signatureLoss[pieceIndex]++;
-             valSum[absValue] += whiteValue < 0 ? 1 : -1;
+         case QaplaInterface::GameResult::BLACK_WINS_BY_ADJUDICATION:
+             count.loss++;
+             statistic.valSum[absValue] += whiteValue < 0 ? 1 : -1;
              gameResult = -1;
              break;
          case QaplaInterface::GameResult::NOT_ENDED:
              return;
          default:
              // Draw (several draw cases)
-             signatureDraw[pieceIndex]++;
+             count.draw++;
              break;
          }
 
@@ -124,12 +156,12 @@ namespace QaplaTraining {
              return;
          }
          if (egFactor >= 80) {
-             for (auto& stat : signatureStatisticsMg) {
+             for (auto& stat : statistic.signatureStatisticsMg) {
                  stat.condAdd(pieceIndex, gameResult, moveInfo.eval, whiteValue, egFactor);
              }
          }
          if (egFactor <= 20) {
-             for (auto& stat : signatureStatisticsEg) {
+             for (auto& stat : statistic.signatureStatisticsEg) {
                  stat.condAdd(pieceIndex, gameResult, moveInfo.eval, whiteValue, 100 - egFactor);
              }
          }
@@ -148,6 +180,7 @@ namespace QaplaTraining {
 			stat.print(centipawnByWinProbability);
 		}
 		writeResultTableAsCppHeader(resultTable, "EvalCorrection.h");
+		writeResultTableAsBinary(resultTable, "eval-correction.bin");
         std::cout << "Analysis finished." << std::endl;
     }
 
@@ -294,6 +327,16 @@ namespace QaplaTraining {
     }
 
 
+    void SignatureEvalAdjuster::writeResultTableAsBinary(const std::vector<AdjustResult>& resultTable, const std::string& filename) {
+        std::vector<int32_t> corrections(resultTable.size());
+        for (size_t i = 0; i < resultTable.size(); ++i) {
+            corrections[i] = resultTable[i].adjustment;
+        }
+        if (ChessEval::SignatureCorrection::saveToFile(filename, corrections)) {
+            std::cout << "Eval correction written to " << filename << std::endl;
+        }
+    }
+
     void SignatureEvalAdjuster::writeResultTableAsCppHeader(const std::vector<AdjustResult>& resultTable, const std::string& filename) {
         std::ofstream out(filename);
         if (!out) {
@@ -375,6 +418,7 @@ namespace QaplaTraining {
 		loadFromFile(filename);
 		auto resultTable = computeResultTable(minAdjust);
 		writeResultTableAsCppHeader(resultTable, "EvalCorrection.h");
+		writeResultTableAsBinary(resultTable, "eval-correction.bin");
 		std::cout << "Result table generated and saved to EvalCorrection.h" << std::endl;
 	}
 
@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include "../interface/ichessboard.h"
 
 namespace QaplaTraining {
@@ -39,10 +40,11 @@ namespace QaplaTraining {
          * @param fenList List of all possible FEN strings
          * @param engine  Prototype chess engine
          * @param filePath Path to the binary game file
+         * @param numThreads Number of threads replaying shards of the file in parallel
          */
         void run(const std::vector<std::string>& fenList,
             const QaplaInterface::IChessBoard* engine,
-            const std::string& filePath);
+            const std::string& filePath, uint32_t numThreads = 1);
 
         void computeFromFile(const std::string& filename);
 
@@ -66,6 +68,12 @@ namespace QaplaTraining {
                 count+= factor;
             }
             void condAdd(uint32_t pieceIndex, int64_t r, int64_t e, int64_t v, int32_t factor);
+            void merge(const AdjustStatistic& other) {
+                result += other.result;
+                evalSum += other.evalSum;
+                valSum += other.valSum;
+                count += other.count;
+            }
             int64_t getEval() {
 				return count != 0 ? static_cast<int64_t>(evalSum / count) : 0;
 			}
@@ -97,6 +105,29 @@ namespace QaplaTraining {
             double valSum;
         };
 
+        /**
+         * Statistic collected by one replay shard. Signatures are stored sparse, as a game 
+         * file reaches only a small part of all signatures
+         */
+        struct ShardStatistic {
+            struct SignatureCount {
+                int64_t win = 0;
+                int64_t draw = 0;
+                int64_t loss = 0;
+                int64_t evalSum = 0;
+            };
+            std::unordered_map<uint32_t, SignatureCount> signatures;
+            std::vector<int64_t> valSum = std::vector<int64_t>(1000);
+            std::vector<int64_t> valTotal = std::vector<int64_t>(1000);
+            std::vector<AdjustStatistic> signatureStatisticsMg;
+            std::vector<AdjustStatistic> signatureStatisticsEg;
+        };
+
+        /**
+         * @brief Adds the statistic of a shard
+         */
+        void merge(const ShardStatistic& statistic);
+
         std::vector<int> ComputeCentipawnByWinProbability();
         /**
          * @brief Smooths the vector using a 1D bilateral filter
@@ -133,6 +164,11 @@ namespace QaplaTraining {
         std::vector<AdjustResult> computeResultTable(int32_t minAdjust);
         void writeResultTableAsCppHeader(const std::vector<AdjustResult>& resultTable, const std::string& filename);
 
+        /**
+         * @brief Writes the adjustments as eval correction file to be loaded at runtime
+         */
+        void writeResultTableAsBinary(const std::vector<AdjustResult>& resultTable, const std::string& filename);
+
         std::vector<int64_t> signatureWin;
         std::vector<int64_t> signatureDraw;
         std::vector<int64_t> signatureLoss;
@@ -142,7 +178,7 @@ namespace QaplaTraining {
 		std::vector<AdjustStatistic> signatureStatisticsMg;
         std::vector<AdjustStatistic> signatureStatisticsEg;
         int32_t minAdjust;
-        void onMove(const MoveInfo& moveInfo);
+        void onMove(const MoveInfo& moveInfo, ShardStatistic& statistic) const;
         void onFinish();
 
         std::array<value_t, 123> midgameV2InPercent = [] {
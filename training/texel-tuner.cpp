@@ -0,0 +1,306 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Texel tuner for the eval tables
+ */
+
+#include <cmath>
+#include <fstream>
+#include <thread>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include "texel-tuner.h"
+
+namespace QaplaTraining {
+
+    using namespace QaplaBasics;
+
+    void TuningDataset::add(const ChessEval::FeatureVector& featureVector, value_t target, value_t residual) {
+        Position position;
+        position.firstFeature = uint32_t(features.size());
+        position.featureCount = uint16_t(featureVector.features.size());
+        position.target = int16_t(std::clamp(target, value_t(-30000), value_t(30000)));
+        position.residual = int16_t(std::clamp(residual, value_t(-30000), value_t(30000)));
+        position.midgameV2InPercent = uint8_t(featureVector.midgameV2InPercent);
+        for (const auto& feature : featureVector.features) {
+            features.push_back(feature.id << 1 | (feature.color == WHITE ? 0 : 1));
+        }
+        positions.push_back(position);
+    }
+
+    bool TuningDataset::save(const std::string& filename, const ChessEval::FeatureLayout& layout) const {
+        std::ofstream out(filename, std::ios::binary);
+        if (!out) {
+            std::cerr << "Failed to open file for writing: " << filename << std::endl;
+            return false;
+        }
+        Header header;
+        header.layoutSize = layout.size();
+        header.layoutHash = layout.computeHash();
+        header.positionCount = positions.size();
+        header.featureCount = features.size();
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(positions.data()), header.positionCount * sizeof(Position));
+        out.write(reinterpret_cast<const char*>(features.data()), header.featureCount * sizeof(uint32_t));
+        return static_cast<bool>(out);
+    }
+
+    bool TuningDataset::load(const std::string& filename, const ChessEval::FeatureLayout& layout) {
+        std::ifstream in(filename, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        Header header;
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!in || header.magic != Header::MAGIC || header.version != Header::VERSION 
+            || header.positionSize != sizeof(Position)) {
+            std::cerr << "Not a tuning dataset of this version: " << filename << std::endl;
+            return false;
+        }
+        if (header.layoutSize != layout.size() || header.layoutHash != layout.computeHash()) {
+            std::cerr << "Tuning dataset was written for another eval layout: " << filename << std::endl;
+            return false;
+        }
+        positions.resize(header.positionCount);
+        features.resize(header.featureCount);
+        in.read(reinterpret_cast<char*>(positions.data()), header.positionCount * sizeof(Position));
+        in.read(reinterpret_cast<char*>(features.data()), header.featureCount * sizeof(uint32_t));
+        if (!in) {
+            std::cerr << "Truncated tuning dataset: " << filename << std::endl;
+            clear();
+            return false;
+        }
+        if (!isValid(layout.size())) {
+            std::cerr << "Corrupt tuning dataset: " << filename << std::endl;
+            clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool TuningDataset::isValid(uint32_t featureIdCount) const {
+        for (const auto& position : positions) {
+            if (uint64_t(position.firstFeature) + position.featureCount > features.size()) {
+                return false;
+            }
+        }
+        for (const auto feature : features) {
+            if ((feature >> 1) >= featureIdCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    TuningThreads::TuningThreads(uint32_t threadCount) {
+        for (uint32_t threadNo = 1; threadNo < threadCount; threadNo++) {
+            workers.emplace_back([this, threadNo]() { work(threadNo); });
+        }
+    }
+
+    TuningThreads::~TuningThreads() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopped = true;
+        }
+        workAvailable.notify_all();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+    }
+
+    void TuningThreads::run(const std::function<void(uint32_t)>& newTask) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            task = &newTask;
+            pending = uint32_t(workers.size());
+            generation++;
+        }
+        workAvailable.notify_all();
+        newTask(0);
+        std::unique_lock<std::mutex> lock(mtx);
+        workFinished.wait(lock, [this] { return pending == 0; });
+        task = nullptr;
+    }
+
+    void TuningThreads::work(uint32_t threadNo) {
+        uint64_t finishedGeneration = 0;
+        while (true) {
+            const std::function<void(uint32_t)>* currentTask;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                workAvailable.wait(lock, [&] { return stopped || generation != finishedGeneration; });
+                if (stopped) return;
+                finishedGeneration = generation;
+                currentTask = task;
+            }
+            (*currentTask)(threadNo);
+            bool last;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                last = --pending == 0;
+            }
+            if (last) {
+                workFinished.notify_one();
+            }
+        }
+    }
+
+    TexelTuner::TexelTuner(const std::vector<EvalValue>& initialWeights)
+        : weights(initialWeights.size() * 2), moment(initialWeights.size() * 2, 0.0),
+        velocity(initialWeights.size() * 2, 0.0), step(0)
+    {
+        for (size_t id = 0; id < initialWeights.size(); id++) {
+            weights[2 * id] = initialWeights[id].midgame();
+            weights[2 * id + 1] = initialWeights[id].endgame();
+        }
+    }
+
+    std::vector<EvalValue> TexelTuner::getWeights() const {
+        std::vector<EvalValue> result(weights.size() / 2);
+        for (size_t id = 0; id < result.size(); id++) {
+            result[id] = EvalValue(value_t(std::lround(weights[2 * id])), value_t(std::lround(weights[2 * id + 1])));
+        }
+        return result;
+    }
+
+    double TexelTuner::evaluate(const TuningDataset& data, const TuningDataset::Position& position) const {
+        double midgame = 0;
+        double endgame = 0;
+        for (uint32_t index = 0; index < position.featureCount; index++) {
+            const uint32_t feature = data.getFeature(position.firstFeature + index);
+            const uint32_t id = feature >> 1;
+            const double sign = (feature & 1) ? -1.0 : 1.0;
+            midgame += sign * weights[2 * id];
+            endgame += sign * weights[2 * id + 1];
+        }
+        const double phase = position.midgameV2InPercent / 100.0;
+        return midgame * phase + endgame * (1.0 - phase) + position.residual;
+    }
+
+    void TexelTuner::addGradient(const TuningDataset& data, const std::vector<uint32_t>& order,
+        size_t begin, size_t end, std::vector<double>& gradient) const
+    {
+        for (size_t index = begin; index < end; index++) {
+            const auto& position = data.getPosition(order[index]);
+            const double probability = winProbability(evaluate(data, position));
+            const double error = probability - winProbability(position.target);
+            // d/dvalue (p - t)^2 with p = sigmoid(value * scale)
+            const double derivative = 2.0 * error * probability * (1.0 - probability) * SIGMOID_SCALE;
+            const double phase = position.midgameV2InPercent / 100.0;
+            for (uint32_t featureNo = 0; featureNo < position.featureCount; featureNo++) {
+                const uint32_t feature = data.getFeature(position.firstFeature + featureNo);
+                const uint32_t id = feature >> 1;
+                const double signedDerivative = (feature & 1) ? -derivative : derivative;
+                gradient[2 * id] += signedDerivative * phase;
+                gradient[2 * id + 1] += signedDerivative * (1.0 - phase);
+            }
+        }
+    }
+
+    void TexelTuner::adamStep(const std::vector<double>& gradient, double learningRate) {
+        step++;
+        const double correction1 = 1.0 - std::pow(ADAM_BETA1, double(step));
+        const double correction2 = 1.0 - std::pow(ADAM_BETA2, double(step));
+        for (size_t index = 0; index < weights.size(); index++) {
+            moment[index] = ADAM_BETA1 * moment[index] + (1.0 - ADAM_BETA1) * gradient[index];
+            velocity[index] = ADAM_BETA2 * velocity[index] + (1.0 - ADAM_BETA2) * gradient[index] * gradient[index];
+            const double momentHat = moment[index] / correction1;
+            const double velocityHat = velocity[index] / correction2;
+            weights[index] -= learningRate * momentHat / (std::sqrt(velocityHat) + ADAM_EPSILON);
+        }
+    }
+
+    double TexelTuner::computeLoss(const TuningDataset& data, size_t begin, size_t end, uint32_t threads) const {
+        if (end <= begin) return 0;
+        TuningThreads tuningThreads(std::max<uint32_t>(1, std::min<uint32_t>(threads, uint32_t(end - begin))));
+        return computeLoss(data, begin, end, tuningThreads);
+    }
+
+    double TexelTuner::computeLoss(const TuningDataset& data, size_t begin, size_t end, TuningThreads& threads) const {
+        if (end <= begin) return 0;
+        const uint32_t threadCount = threads.size();
+        std::vector<double> sums(threadCount, 0.0);
+        threads.run([&](uint32_t threadNo) {
+            const size_t first = begin + (end - begin) * threadNo / threadCount;
+            const size_t last = begin + (end - begin) * (threadNo + 1) / threadCount;
+            double sum = 0;
+            for (size_t index = first; index < last; index++) {
+                const auto& position = data.getPosition(index);
+                const double error = winProbability(evaluate(data, position)) - winProbability(position.target);
+                sum += error * error;
+            }
+            sums[threadNo] = sum;
+        });
+        return std::accumulate(sums.begin(), sums.end(), 0.0) / double(end - begin);
+    }
+
+    void TexelTuner::run(const TuningDataset& data, const Settings& settings, std::ostream& os) {
+        const size_t validationSize = size_t(double(data.size()) * settings.validationShare);
+        const size_t trainingSize = data.size() - validationSize;
+        const uint32_t threads = std::max<uint32_t>(1, settings.threads);
+        const size_t batchSize = std::max<size_t>(1, settings.batchSize);
+        if (trainingSize == 0) {
+            os << "No positions to tune" << std::endl;
+            return;
+        }
+        if (!data.isValid(uint32_t(weights.size() / 2))) {
+            os << "The tuning dataset does not match the weights" << std::endl;
+            return;
+        }
+
+        std::vector<uint32_t> order(trainingSize);
+        std::iota(order.begin(), order.end(), 0);
+        std::mt19937 random(0);
+        std::vector<std::vector<double>> threadGradients(threads, std::vector<double>(weights.size()));
+        std::vector<double> gradient(weights.size());
+        TuningThreads tuningThreads(threads);
+
+        os << "Positions: " << trainingSize << " training, " << validationSize << " validation" << std::endl;
+        os << "Epoch: 0 loss: " << computeLoss(data, 0, trainingSize, tuningThreads)
+            << " validation loss: " << computeLoss(data, trainingSize, data.size(), tuningThreads) << std::endl;
+
+        for (uint32_t epoch = 1; epoch <= settings.epochs; epoch++) {
+            std::shuffle(order.begin(), order.end(), random);
+            for (size_t batchBegin = 0; batchBegin < trainingSize; batchBegin += batchSize) {
+                const size_t batchEnd = std::min(trainingSize, batchBegin + batchSize);
+                const size_t batchLength = batchEnd - batchBegin;
+                tuningThreads.run([&](uint32_t threadNo) {
+                    auto& threadGradient = threadGradients[threadNo];
+                    std::fill(threadGradient.begin(), threadGradient.end(), 0.0);
+                    addGradient(data, order,
+                        batchBegin + batchLength * threadNo / threads,
+                        batchBegin + batchLength * (threadNo + 1) / threads,
+                        threadGradient);
+                });
+                for (size_t index = 0; index < gradient.size(); index++) {
+                    double sum = 0;
+                    for (uint32_t threadNo = 0; threadNo < threads; threadNo++) {
+                        sum += threadGradients[threadNo][index];
+                    }
+                    gradient[index] = sum / double(batchLength);
+                }
+                adamStep(gradient, settings.learningRate);
+            }
+            os << "Epoch: " << epoch << " loss: " << computeLoss(data, 0, trainingSize, tuningThreads)
+                << " validation loss: " << computeLoss(data, trainingSize, data.size(), tuningThreads) << std::endl;
+        }
+    }
+
+}
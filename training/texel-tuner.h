@@ -0,0 +1,222 @@
+/**
+ * @license
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @author Volker Böhm
+ * @copyright Copyright (c) 2025 Volker Böhm
+ * @Overview
+ * Texel tuner for the eval tables. Positions are extracted once into a compact feature
+ * dataset. The tuner then minimizes the squared difference between the win probability
+ * of the linear eval and the one of the search value using parallel mini-batch Adam.
+ * Eval terms without a table (e.g. king distance to passed pawns) are kept as a fixed
+ * residual per position.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+#include "../basics/types.h"
+#include "../basics/evalvalue.h"
+#include "../eval/feature-layout.h"
+
+namespace QaplaTraining {
+
+    /**
+     * Feature vectors of many positions in one flat array
+     */
+    class TuningDataset {
+    public:
+        struct Position {
+            uint32_t firstFeature;
+            uint16_t featureCount;
+            int16_t target;
+            int16_t residual;
+            uint8_t midgameV2InPercent;
+            // Explicit padding, thus saved datasets do not contain uninitialized bytes
+            uint8_t reserved = 0;
+        };
+
+        /**
+         * File layout: header, positionCount positions, featureCount features
+         */
+        struct Header {
+            static constexpr uint32_t MAGIC = 0x54445051; // "QPDT"
+            static constexpr uint32_t VERSION = 1;
+            uint32_t magic = MAGIC;
+            uint32_t version = VERSION;
+            uint32_t positionSize = sizeof(Position);
+            // Amount of feature ids of the FeatureLayout the features refer to
+            uint32_t layoutSize = 0;
+            uint64_t layoutHash = 0;
+            uint64_t positionCount = 0;
+            uint64_t featureCount = 0;
+        };
+
+        /**
+         * @brief Adds a position
+         * @param features Feature ids of the position
+         * @param target   Search value from the view of white
+         * @param residual Part of the eval not covered by the features, from the view of white
+         */
+        void add(const ChessEval::FeatureVector& features, QaplaBasics::value_t target, QaplaBasics::value_t residual);
+
+        /**
+         * @brief Writes the dataset in binary format
+         * @param layout Layout the feature ids refer to
+         */
+        bool save(const std::string& filename, const ChessEval::FeatureLayout& layout) const;
+
+        /**
+         * @brief Reads a dataset written by save
+         * @returns false, if the file is missing, truncated, of another format version or 
+         * written for another layout
+         */
+        bool load(const std::string& filename, const ChessEval::FeatureLayout& layout);
+
+        /**
+         * @brief Checks, that every position refers to features inside the feature array
+         * and every feature id is below featureIdCount
+         */
+        bool isValid(uint32_t featureIdCount) const;
+
+        void clear() {
+            positions.clear();
+            features.clear();
+        }
+
+        size_t size() const { return positions.size(); }
+
+        const Position& getPosition(size_t index) const { return positions[index]; }
+
+        /**
+         * @brief Gets a feature as id << 1 | (1, if the feature counts for black)
+         */
+        uint32_t getFeature(size_t index) const { return features[index]; }
+
+    private:
+        std::vector<Position> positions;
+        std::vector<uint32_t> features;
+    };
+
+    /**
+     * Threads kept alive over a tuning run. Every call of run hands one task to all threads
+     * and returns after all of them finished it, thus the threads are created once and not
+     * for every mini batch.
+     */
+    class TuningThreads {
+    public:
+        explicit TuningThreads(uint32_t threadCount);
+        ~TuningThreads();
+        TuningThreads(const TuningThreads&) = delete;
+        TuningThreads& operator=(const TuningThreads&) = delete;
+
+        uint32_t size() const { return uint32_t(workers.size()) + 1; }
+
+        /**
+         * @brief Runs task(threadNo) for threadNo in [0, size()), thread 0 is the calling thread
+         */
+        void run(const std::function<void(uint32_t)>& task);
+
+    private:
+        void work(uint32_t threadNo);
+
+        std::vector<std::thread> workers;
+        std::mutex mtx;
+        std::condition_variable workAvailable;
+        std::condition_variable workFinished;
+        const std::function<void(uint32_t)>* task = nullptr;
+        // Incremented for every task, a worker runs each generation once
+        uint64_t generation = 0;
+        uint32_t pending = 0;
+        bool stopped = false;
+    };
+
+    class TexelTuner {
+    public:
+        struct Settings {
+            uint32_t threads = 1;
+            uint32_t epochs = 100;
+            uint32_t batchSize = 16384;
+            double learningRate = 0.5;
+            // Share of positions at the end of the dataset used for validation only
+            double validationShare = 0.05;
+        };
+
+        /**
+         * @param initialWeights Dense weights of a FeatureLayout to start from
+         */
+        TexelTuner(const std::vector<QaplaBasics::EvalValue>& initialWeights);
+
+        /**
+         * @brief Tunes the weights
+         * @param data     Positions to tune on
+         * @param settings Tuning parameters
+         * @param os       Stream for the progress information
+         */
+        void run(const TuningDataset& data, const Settings& settings, std::ostream& os);
+
+        /**
+         * @brief Gets the tuned weights rounded to centipawns
+         */
+        std::vector<QaplaBasics::EvalValue> getWeights() const;
+
+        /**
+         * @brief Computes the mean loss over the positions [begin, end)
+         */
+        double computeLoss(const TuningDataset& data, size_t begin, size_t end, uint32_t threads) const;
+
+    private:
+        double computeLoss(const TuningDataset& data, size_t begin, size_t end, TuningThreads& threads) const;
+
+        /**
+         * @brief Computes the eval of a position from the view of white
+         */
+        double evaluate(const TuningDataset& data, const TuningDataset::Position& position) const;
+
+        /**
+         * @brief Adds the loss gradient of the positions order[begin, end) to gradient
+         */
+        void addGradient(const TuningDataset& data, const std::vector<uint32_t>& order,
+            size_t begin, size_t end, std::vector<double>& gradient) const;
+
+        /**
+         * @brief Updates the weights with the averaged gradient of a mini batch
+         */
+        void adamStep(const std::vector<double>& gradient, double learningRate);
+
+        static double winProbability(double value) {
+            return 1.0 / (1.0 + std::exp(-value * SIGMOID_SCALE));
+        }
+
+        // Maps centipawns to a win probability: 400 centipawns are 10:1 odds
+        static constexpr double SIGMOID_SCALE = 2.302585092994046 / 400.0;
+        static constexpr double ADAM_BETA1 = 0.9;
+        static constexpr double ADAM_BETA2 = 0.999;
+        static constexpr double ADAM_EPSILON = 1e-8;
+
+        // Midgame weight at 2 * id, endgame weight at 2 * id + 1
+        std::vector<double> weights;
+        std::vector<double> moment;
+        std::vector<double> velocity;
+        uint64_t step;
+    };
+
+}